@@ -5,12 +5,47 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
 #include <random>
+#include <shared_mutex>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <tuple>
+#include <vector>
+#ifdef __linux__
+// posix
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+// shared-memory framebuffer ring
+#include "shm_framebuffer.h"
+#endif
+#ifdef __SSE2__
+// simd
+#include <emmintrin.h>
+#endif
 // anari
 #define ANARI_EXTENSION_UTILITY_IMPL
 #include <anari/anari_cpp.hpp>
@@ -22,27 +57,223 @@
 using namespace anari::math;
 
 // ========================================================
-// Log ANARI errors
+// Status message attribution: every device gets a registry
+//  (passed as the status callback's userData) of the objects
+//  created on it, with creation site and thread role, and
+//  aggregates its messages by where they come from
 // ========================================================
-static void statusFunc(const void * /*userData*/,
+
+// Role of the calling thread, set by the thread itself
+static thread_local const char *threadRole = nullptr;
+
+static void setThreadRole(const char *role)
+{
+  threadRole = role;
+}
+
+static const char *objectTypeName(ANARIDataType type)
+{
+  switch (type) {
+  case ANARI_DEVICE:
+    return "device";
+  case ANARI_ARRAY1D:
+  case ANARI_ARRAY2D:
+  case ANARI_ARRAY3D:
+    return "array";
+  case ANARI_CAMERA:
+    return "camera";
+  case ANARI_FRAME:
+    return "frame";
+  case ANARI_GEOMETRY:
+    return "geometry";
+  case ANARI_GROUP:
+    return "group";
+  case ANARI_INSTANCE:
+    return "instance";
+  case ANARI_LIGHT:
+    return "light";
+  case ANARI_MATERIAL:
+    return "material";
+  case ANARI_RENDERER:
+    return "renderer";
+  case ANARI_SAMPLER:
+    return "sampler";
+  case ANARI_SPATIAL_FIELD:
+    return "spatial field";
+  case ANARI_SURFACE:
+    return "surface";
+  case ANARI_VOLUME:
+    return "volume";
+  case ANARI_WORLD:
+    return "world";
+  default:
+    return "object";
+  }
+}
+
+static const char *severityTag(ANARIStatusSeverity severity)
+{
+  switch (severity) {
+  case ANARI_SEVERITY_FATAL_ERROR:
+    return "FATAL";
+  case ANARI_SEVERITY_ERROR:
+    return "ERROR";
+  case ANARI_SEVERITY_WARNING:
+    return "WARN ";
+  case ANARI_SEVERITY_PERFORMANCE_WARNING:
+    return "PERF ";
+  default:
+    return nullptr; // INFO/DEBUG are ignored
+  }
+}
+
+struct StatusRegistry
+{
+  struct Origin
+  {
+    std::string site;
+    std::string role;
+  };
+
+  struct Count
+  {
+    uint64_t count{0};
+    std::string example;
+  };
+
+  std::string label;
+  std::mutex mutex;
+  // Released handles are not removed; an address the device hands out
+  // again is overwritten when the new object is tracked
+  std::map<const void *, Origin> objects;
+  // (severity, code, source type, site, role) -> messages
+  std::map<std::tuple<int, int, int, std::string, std::string>, Count> counts;
+
+  void track(const void *object, const char *site)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    objects[object] = {site, threadRole ? threadRole : "unnamed thread"};
+  }
+
+  // Returns the attribution of 'source' for the log line
+  std::string record(const void *source,
+      ANARIDataType sourceType,
+      ANARIStatusSeverity severity,
+      ANARIStatusCode code,
+      const char *message)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = objects.find(source);
+    const Origin origin =
+        it != objects.end() ? it->second : Origin{"untracked site", "-"};
+    auto &c = counts[std::make_tuple(
+        int(severity), int(code), int(sourceType), origin.site, origin.role)];
+    if (c.count++ == 0)
+      c.example = message;
+    return label + ": " + objectTypeName(sourceType) + " from " + origin.site
+        + " on " + origin.role;
+  }
+
+  void printSummary()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (counts.empty())
+      return;
+    printf("status messages (%s):\n", label.c_str());
+    for (const auto &entry : counts) {
+      const auto &key = entry.first;
+      printf("  %llu x [%s] code %d from %s created in %s on %s, "
+             "e.g. \"%s\"\n",
+          (unsigned long long)entry.second.count,
+          severityTag(std::get<0>(key)),
+          std::get<1>(key),
+          objectTypeName(std::get<2>(key)),
+          std::get<3>(key).c_str(),
+          std::get<4>(key).c_str(),
+          entry.second.example.c_str());
+    }
+  }
+};
+
+// Devices -> registries, so that creation sites can find theirs
+static std::mutex statusRegistriesMutex;
+static std::map<const void *, StatusRegistry *> statusRegistries;
+
+static void statusFunc(const void *userData,
     ANARIDevice /*device*/,
     ANARIObject source,
-    ANARIDataType /*sourceType*/,
+    ANARIDataType sourceType,
     ANARIStatusSeverity severity,
-    ANARIStatusCode /*code*/,
+    ANARIStatusCode code,
     const char *message)
 {
-  if (severity == ANARI_SEVERITY_FATAL_ERROR) {
-    fprintf(stderr, "[FATAL][%p] %s\n", source, message);
+  const char *tag = severityTag(severity);
+  if (!tag)
+    return;
+
+  // The library-level callback (before a device is set up) has no registry
+  auto *registry = (StatusRegistry *)userData;
+  if (registry) {
+    const auto origin =
+        registry->record(source, sourceType, severity, code, message);
+    fprintf(
+        stderr, "[%s][%p, %s] %s\n", tag, source, origin.c_str(), message);
+  } else {
+    fprintf(stderr, "[%s][%p] %s\n", tag, source, message);
+  }
+
+  if (severity == ANARI_SEVERITY_FATAL_ERROR)
     std::exit(1);
-  } else if (severity == ANARI_SEVERITY_ERROR) {
-    fprintf(stderr, "[ERROR][%p] %s\n", source, message);
-  } else if (severity == ANARI_SEVERITY_WARNING) {
-    fprintf(stderr, "[WARN ][%p] %s\n", source, message);
-  } else if (severity == ANARI_SEVERITY_PERFORMANCE_WARNING) {
-    fprintf(stderr, "[PERF ][%p] %s\n", source, message);
+}
+
+// Route the device's status messages to 'registry' via userData
+static void attachStatusRegistry(
+    anari::Device device, StatusRegistry &registry, const std::string &label)
+{
+  registry.label = label;
+  {
+    std::lock_guard<std::mutex> lock(statusRegistriesMutex);
+    statusRegistries[device] = &registry;
+  }
+  registry.track(device, "anari::newDevice");
+
+  ANARIStatusCallback callback = statusFunc;
+  const void *userData = &registry;
+  anariSetParameter(
+      device, device, "statusCallback", ANARI_STATUS_CALLBACK, &callback);
+  anariSetParameter(device,
+      device,
+      "statusCallbackUserData",
+      ANARI_VOID_POINTER,
+      &userData);
+  anariCommitParameters(device, device);
+}
+
+// Call after releasing the device, so that messages from its teardown are
+// still counted; 'device' is only used as the lookup key
+static void detachStatusRegistry(anari::Device device)
+{
+  StatusRegistry *registry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(statusRegistriesMutex);
+    auto it = statusRegistries.find(device);
+    if (it == statusRegistries.end())
+      return;
+    registry = it->second;
+    statusRegistries.erase(it);
   }
-  // Ignore INFO/DEBUG messages
+  registry->printSummary();
+}
+
+// Record where (function) and by whom (thread role) 'object' was created
+template <typename T>
+static T tracked(anari::Device device, T object, const char *site)
+{
+  std::lock_guard<std::mutex> lock(statusRegistriesMutex);
+  auto it = statusRegistries.find(device);
+  if (it != statusRegistries.end())
+    it->second->track(object, site);
+  return object;
 }
 
 // ========================================================
@@ -63,59 +294,157 @@ static bool deviceHasExtension(anari::Library library,
 }
 
 // ========================================================
-// generate our test scene
+// Description of the generated sphere set
+// ========================================================
+struct SphereSet
+{
+  uint32_t numSpheres{10000};
+  float radius{.015f};
+  uint32_t seed{0};
+  // Only the part partIndex of numParts disjoint subsets is generated
+  uint32_t partIndex{0};
+  uint32_t numParts{1};
+
+  uint32_t partBegin() const
+  {
+    return uint64_t(numSpheres) * partIndex / numParts;
+  }
+  uint32_t partEnd() const
+  {
+    return uint64_t(numSpheres) * (partIndex + 1) / numParts;
+  }
+  uint32_t partSize() const
+  {
+    return partEnd() - partBegin();
+  }
+};
+
+// ========================================================
+// generate sphere positions, distances to the center and
+//  a shuffled index list (any output may be null)
 // ========================================================
-void initializeWorld(anari::Device device, anari::World world, const float3 &pos)
+static void generateSpheres(const SphereSet &set,
+    const float3 &pos,
+    float3 *positions,
+    float *distances,
+    uint32_t *indices)
 {
-  const uint32_t numSpheres = 10000;
-  const float radius = .015f;
+  const uint32_t partBegin = set.partBegin();
+  const uint32_t partEnd = set.partEnd();
 
   std::mt19937 rng;
-  rng.seed(0);
+  rng.seed(set.seed);
   std::normal_distribution<float> vert_dist(0.f, 0.25f);
 
+  for (uint32_t i = 0; i < set.numSpheres; i++) {
+    // always draw all samples so every part sees the same sphere set
+    const auto a = vert_dist(rng);
+    const auto b = vert_dist(rng);
+    const auto c = vert_dist(rng);
+    if (i < partBegin || i >= partEnd)
+      continue;
+    const uint32_t j = i - partBegin;
+    if (positions) {
+      positions[j] = float3(a, b, c);
+      // translate
+      positions[j] += pos;
+    }
+    if (distances)
+      distances[j] = std::sqrt(a * a + b * b + c * c); // will be roughly 0-1
+  }
+
+  if (indices) {
+    std::iota(indices, indices + set.partSize(), 0);
+    std::shuffle(indices, indices + set.partSize(), rng);
+  }
+}
+
+// ========================================================
+// Create a sphere geometry from a generated sphere set
+// ========================================================
+static anari::Geometry newSphereGeometry(
+    anari::Device device, const SphereSet &set, const float3 &pos)
+{
+  const uint32_t numSpheres = set.partSize();
+
   // Create + fill position and color arrays with randomized values //
 
-  auto indicesArray = anari::newArray1D(device, ANARI_UINT32, numSpheres);
-  auto positionsArray =
-      anari::newArray1D(device, ANARI_FLOAT32_VEC3, numSpheres);
-  auto distanceArray = anari::newArray1D(device, ANARI_FLOAT32, numSpheres);
+  auto indicesArray = tracked(
+      device, anari::newArray1D(device, ANARI_UINT32, numSpheres), __func__);
+  auto positionsArray = tracked(device,
+      anari::newArray1D(device, ANARI_FLOAT32_VEC3, numSpheres),
+      __func__);
+  auto distanceArray = tracked(
+      device, anari::newArray1D(device, ANARI_FLOAT32, numSpheres), __func__);
   {
     auto *positions = anari::map<float3>(device, positionsArray);
     auto *distances = anari::map<float>(device, distanceArray);
-    for (uint32_t i = 0; i < numSpheres; i++) {
-      const auto a = positions[i][0] = vert_dist(rng);
-      const auto b = positions[i][1] = vert_dist(rng);
-      const auto c = positions[i][2] = vert_dist(rng);
-      distances[i] = std::sqrt(a * a + b * b + c * c); // will be roughly 0-1
-      // translate
-      positions[i] += pos;
-    }
+    auto *indices = anari::map<uint32_t>(device, indicesArray);
+    generateSpheres(set, pos, positions, distances, indices);
     anari::unmap(device, positionsArray);
     anari::unmap(device, distanceArray);
-
-    auto *indicesBegin = anari::map<uint32_t>(device, indicesArray);
-    auto *indicesEnd = indicesBegin + numSpheres;
-    std::iota(indicesBegin, indicesEnd, 0);
-    std::shuffle(indicesBegin, indicesEnd, rng);
     anari::unmap(device, indicesArray);
   }
 
   // Create and parameterize geometry //
 
-  auto geometry = anari::newObject<anari::Geometry>(device, "sphere");
+  auto geometry = tracked(
+      device, anari::newObject<anari::Geometry>(device, "sphere"), __func__);
   anari::setAndReleaseParameter(
       device, geometry, "primitive.index", indicesArray);
   anari::setAndReleaseParameter(
       device, geometry, "vertex.position", positionsArray);
   anari::setAndReleaseParameter(
       device, geometry, "vertex.attribute0", distanceArray);
+  anari::setParameter(device, geometry, "radius", set.radius);
+  anari::commitParameters(device, geometry);
+  return geometry;
+}
+
+// ========================================================
+// Create a sphere geometry from application-side arrays
+// ========================================================
+static anari::Geometry newSphereGeometry(anari::Device device,
+    const float3 *positions,
+    const float *distances,
+    uint32_t numSpheres,
+    float radius)
+{
+  auto positionsArray = tracked(device,
+      anari::newArray1D(device, ANARI_FLOAT32_VEC3, numSpheres),
+      __func__);
+  std::copy(positions,
+      positions + numSpheres,
+      anari::map<float3>(device, positionsArray));
+  anari::unmap(device, positionsArray);
+
+  auto distanceArray = tracked(
+      device, anari::newArray1D(device, ANARI_FLOAT32, numSpheres), __func__);
+  std::copy(distances,
+      distances + numSpheres,
+      anari::map<float>(device, distanceArray));
+  anari::unmap(device, distanceArray);
+
+  auto geometry = tracked(
+      device, anari::newObject<anari::Geometry>(device, "sphere"), __func__);
+  anari::setAndReleaseParameter(
+      device, geometry, "vertex.position", positionsArray);
+  anari::setAndReleaseParameter(
+      device, geometry, "vertex.attribute0", distanceArray);
   anari::setParameter(device, geometry, "radius", radius);
   anari::commitParameters(device, geometry);
+  return geometry;
+}
 
+// ========================================================
+// Create the red-to-green color map material
+// ========================================================
+static anari::Material newColorMapMaterial(anari::Device device)
+{
   // Create color map texture //
 
-  auto texelArray = anari::newArray1D(device, ANARI_FLOAT32_VEC3, 2);
+  auto texelArray = tracked(
+      device, anari::newArray1D(device, ANARI_FLOAT32_VEC3, 2), __func__);
   {
     auto *texels = anari::map<float3>(device, texelArray);
     texels[0][0] = 1.f;
@@ -127,44 +456,123 @@ void initializeWorld(anari::Device device, anari::World world, const float3 &pos
     anari::unmap(device, texelArray);
   }
 
-  auto texture = anari::newObject<anari::Sampler>(device, "image1D");
+  auto texture = tracked(
+      device, anari::newObject<anari::Sampler>(device, "image1D"), __func__);
   anari::setAndReleaseParameter(device, texture, "image", texelArray);
   anari::setParameter(device, texture, "filter", "linear");
   anari::commitParameters(device, texture);
 
   // Create and parameterize material //
 
-  auto material = anari::newObject<anari::Material>(device, "matte");
+  auto material = tracked(
+      device, anari::newObject<anari::Material>(device, "matte"), __func__);
   anari::setAndReleaseParameter(device, material, "color", texture);
   anari::commitParameters(device, material);
+  return material;
+}
+
+// ========================================================
+// Ways to pass an array of object handles as a parameter
+// ========================================================
+enum class ObjectArrayPath
+{
+  NEW_AND_MAP, // newArray1D(type, n) + map/copy/unmap
+  APP_MEMORY, // newArray1D(device, objects, n) on application memory
+  SET_PARAMETER // setParameterArray1D(), array created behind the scenes
+};
+
+static const char *objectArrayPathName(ObjectArrayPath path)
+{
+  switch (path) {
+  case ObjectArrayPath::NEW_AND_MAP:
+    return "map";
+  case ObjectArrayPath::APP_MEMORY:
+    return "appmem";
+  default:
+    return "param";
+  }
+}
+
+static bool parseObjectArrayPath(const std::string &name, ObjectArrayPath &path)
+{
+  for (auto p : {ObjectArrayPath::NEW_AND_MAP,
+           ObjectArrayPath::APP_MEMORY,
+           ObjectArrayPath::SET_PARAMETER}) {
+    if (name == objectArrayPathName(p)) {
+      path = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+// With APP_MEMORY, objects must stay valid as long as the array is in use
+template <typename T>
+static void setObjectArray(anari::Device device,
+    anari::Object object,
+    const char *name,
+    ANARIDataType type,
+    const T *objects,
+    uint32_t count,
+    ObjectArrayPath path)
+{
+  switch (path) {
+  case ObjectArrayPath::NEW_AND_MAP: {
+    auto array =
+        tracked(device, anari::newArray1D(device, type, count), __func__);
+    std::copy(objects, objects + count, anari::map<T>(device, array));
+    anari::unmap(device, array);
+    anari::setAndReleaseParameter(device, object, name, array);
+    break;
+  }
+  case ObjectArrayPath::APP_MEMORY:
+    anari::setAndReleaseParameter(device,
+        object,
+        name,
+        tracked(device, anari::newArray1D(device, objects, count), __func__));
+    break;
+  case ObjectArrayPath::SET_PARAMETER:
+    anari::setParameterArray1D(device, object, name, objects, count);
+    break;
+  }
+}
 
+// ========================================================
+// Put a geometry (with the color map material) and a light
+//  into a world; the caller keeps its geometry reference
+// ========================================================
+static void initializeWorld(anari::Device device,
+    anari::World world,
+    anari::Geometry geometry,
+    ObjectArrayPath surfacePath = ObjectArrayPath::NEW_AND_MAP)
+{
   // Create and parameterize surface //
 
-  auto surface = anari::newObject<anari::Surface>(device);
-  anari::setAndReleaseParameter(device, surface, "geometry", geometry);
-  anari::setAndReleaseParameter(device, surface, "material", material);
+  auto surface =
+      tracked(device, anari::newObject<anari::Surface>(device), __func__);
+  anari::setParameter(device, surface, "geometry", geometry);
+  anari::setAndReleaseParameter(
+      device, surface, "material", newColorMapMaterial(device));
   anari::commitParameters(device, surface);
 
   // Create and parameterize world //
 
-#if 1
-  {
-    auto surfaceArray = anari::newArray1D(device, ANARI_SURFACE, 1);
-    auto *s = anari::map<anari::Surface>(device, surfaceArray);
-    s[0] = surface;
-    anari::unmap(device, surfaceArray);
-    anari::setAndReleaseParameter(device, world, "surface", surfaceArray);
-  }
-#else
-  anari::setAndReleaseParameter(
-      device, world, "surface", anari::newArray1D(device, &surface));
-#endif
+  setObjectArray(
+      device, world, "surface", ANARI_SURFACE, &surface, 1, surfacePath);
   anari::release(device, surface);
 
   // Add a directional light source //
 
-  auto light = anari::newObject<anari::Light>(device, "directional");
-  anari::setParameterArray1D(device, world, "light", &light, 1);
+  auto light = tracked(device,
+      anari::newObject<anari::Light>(device, "directional"),
+      __func__);
+  setObjectArray(device,
+      world,
+      "light",
+      ANARI_LIGHT,
+      &light,
+      1,
+      ObjectArrayPath::SET_PARAMETER);
   anari::release(device, light);
 
   // Commit world //
@@ -172,12 +580,27 @@ void initializeWorld(anari::Device device, anari::World world, const float3 &pos
   anari::commitParameters(device, world);
 }
 
+// ========================================================
+// generate our test scene
+// ========================================================
+void initializeWorld(anari::Device device,
+    anari::World world,
+    const float3 &pos,
+    const SphereSet &set = {},
+    ObjectArrayPath surfacePath = ObjectArrayPath::NEW_AND_MAP)
+{
+  auto geometry = newSphereGeometry(device, set, pos);
+  initializeWorld(device, world, geometry, surfacePath);
+  anari::release(device, geometry);
+}
+
 // ========================================================
 // Function to initialize a renderer
 // ========================================================
+static const float4 backgroundColor = {0.1f, 0.1f, 0.1f, 1.f};
+
 static void initializeRenderer(anari::Device device, anari::Renderer renderer)
 {
-  const float4 backgroundColor = {0.1f, 0.1f, 0.1f, 1.f};
   anari::setParameter(device, renderer, "background", backgroundColor);
   anari::setParameter(device, renderer, "pixelSamples", 1);
   anari::commitParameters(device, renderer);
@@ -186,9 +609,15 @@ static void initializeRenderer(anari::Device device, anari::Renderer renderer)
 // ========================================================
 // Function to initialize a camera
 // ========================================================
+
+// Center of the generated spheres, and the default eye point looking at
+// them down -z (so +x is right)
+static const float3 sceneCenter(1.5f, 1.5f, 0.f);
+static const float3 sceneEye(1.5f, 1.68f, 1.5f);
+
 static void initializeCamera(anari::Device device, anari::Camera camera)
 {
-  anari::setParameter(device, camera, "position", float3(1.5f, 1.68f, 1.5f));
+  anari::setParameter(device, camera, "position", sceneEye);
   anari::setParameter(device, camera, "direction", float3(0, 0, -1));
   anari::setParameter(device, camera, "up", float3(0, 1, 0));
   anari::commitParameters(device, camera);
@@ -214,168 +643,4622 @@ static void initializeFrame(anari::Device device,
 }
 
 // ========================================================
-// Function to render a given frame (renderer+world+cam)
-//  and (optionally) produce an output image
+// Timing helpers
 // ========================================================
-static void render(
-    anari::Device device, anari::Frame frame, const std::string &fileName)
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMS(Clock::time_point begin, Clock::time_point end)
 {
-  // Render frame and print out duration property //
+  return std::chrono::duration<double, std::milli>(end - begin).count();
+}
 
-  anari::render(device, frame);
-  anari::wait(device, frame);
+struct TimingStats
+{
+  double mean{0.0};
+  double stddev{0.0};
+  double min{0.0};
+  double p50{0.0};
+  double p95{0.0};
+  double p99{0.0};
+  double max{0.0};
+};
 
-  float duration = 0.f;
-  anari::getProperty(device, frame, "duration", duration, ANARI_NO_WAIT);
+static TimingStats computeStats(std::vector<double> samples)
+{
+  TimingStats stats;
+  if (samples.empty())
+    return stats;
 
-  printf("rendered frame in %fms\n", duration * 1000);
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&](double p) {
+    size_t idx = size_t(std::ceil(p * samples.size())) - 1;
+    return samples[std::min(idx, samples.size() - 1)];
+  };
 
-  if (!fileName.empty()) {
-    stbi_flip_vertically_on_write(1);
-    auto fb = anari::map<uint32_t>(device, frame, "channel.color");
-    stbi_write_png(
-        fileName.c_str(), fb.width, fb.height, 4, fb.data, 4 * fb.width);
-    anari::unmap(device, frame, "channel.color");
+  stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0)
+      / samples.size();
+  double var = 0.0;
+  for (double s : samples)
+    var += (s - stats.mean) * (s - stats.mean);
+  stats.stddev = std::sqrt(var / samples.size());
+  stats.min = samples.front();
+  stats.p50 = percentile(0.50);
+  stats.p95 = percentile(0.95);
+  stats.p99 = percentile(0.99);
+  stats.max = samples.back();
+  return stats;
+}
 
-    std::cout << "Output: " << fileName << '\n';
+// Call fn numWarmup + numTimed times; returns the durations [ms] of the
+// timed calls
+template <typename F>
+static std::vector<double> measureRepeated(int numWarmup, int numTimed, F &&fn)
+{
+  std::vector<double> times;
+  for (int i = 0; i < numWarmup + numTimed; i++) {
+    auto begin = Clock::now();
+    fn();
+    if (i >= numWarmup)
+      times.push_back(elapsedMS(begin, Clock::now()));
   }
+  return times;
 }
 
-int main()
+// ========================================================
+// Split [0, n) into contiguous chunks, one per thread
+// ========================================================
+template <typename F>
+static void parallelFor(size_t n, int numThreads, F &&fn)
 {
-  // Setup ANARI device //
+  numThreads = int(std::max<size_t>(1, std::min<size_t>(numThreads, n)));
+  if (numThreads == 1) {
+    fn(size_t(0), n);
+    return;
+  }
 
-  auto library = anari::loadLibrary("environment", statusFunc);
-  auto device = anari::newDevice(library, "default");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    const size_t begin = n * t / numThreads;
+    const size_t end = n * (t + 1) / numThreads;
+    threads.emplace_back([&fn, begin, end]() {
+      setThreadRole("parallelForThread");
+      fn(begin, end);
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+}
 
-  // Create world from a helper function //
+// Scalar, single-threaded SIMD and multi-threaded SIMD runs of one kernel
+struct KernelVariant
+{
+  const char *name;
+  bool simd;
+  int threads;
+};
 
-  anari::World world = anari::newObject<anari::World>(device);
-  std::thread initWorldThread([&]() {
-    initializeWorld(device, world, float3(1.5f, 1.5f, 0.f));
-    fprintf(stdout, "%s\n", "world initialization thread finished");
-  });
+static std::vector<KernelVariant> kernelVariants(int numThreads)
+{
+  return {{"scalar", false, 1}, {"simd", true, 1}, {"simd", true, numThreads}};
+}
 
-  // Create renderer //
-  anari::Renderer renderer = anari::newObject<anari::Renderer>(device, "default");
-  std::thread initRendererThread([&]() {
-    initializeRenderer(device, renderer);
-    fprintf(stdout, "%s\n", "renderer initialization thread finished");
-  });
+// ========================================================
+// Scene (world+renderer+camera+frame) used by the benchmark modes
+// ========================================================
+struct Scene
+{
+  anari::World world{nullptr};
+  anari::Renderer renderer{nullptr};
+  anari::Camera camera{nullptr};
+  anari::Frame frame{nullptr};
+};
 
-  // Create camera //
+// Renderer, camera and frame around 'world', which the scene takes over
+static Scene createScene(anari::Device device, anari::World world)
+{
+  Scene scene;
+  scene.world = world;
+  scene.renderer = tracked(device,
+      anari::newObject<anari::Renderer>(device, "default"),
+      __func__);
+  initializeRenderer(device, scene.renderer);
+  scene.camera = tracked(device,
+      anari::newObject<anari::Camera>(device, "perspective"),
+      __func__);
+  initializeCamera(device, scene.camera);
+  scene.frame =
+      tracked(device, anari::newObject<anari::Frame>(device), __func__);
+  initializeFrame(
+      device, scene.frame, scene.world, scene.renderer, scene.camera);
+  return scene;
+}
 
-  auto camera = anari::newObject<anari::Camera>(device, "perspective");
-  std::thread initCameraThread([&]() {
-    initializeCamera(device, camera);
-    fprintf(stdout, "%s\n", "camera initialization thread finished");
-  });
+static Scene createScene(anari::Device device, const SphereSet &set = {})
+{
+  auto world =
+      tracked(device, anari::newObject<anari::World>(device), __func__);
+  initializeWorld(device, world, sceneCenter, set);
+  return createScene(device, world);
+}
 
-  // Create frame (top-level object) //
+static void releaseScene(anari::Device device, Scene &scene)
+{
+  anari::release(device, scene.camera);
+  anari::release(device, scene.renderer);
+  anari::release(device, scene.world);
+  anari::release(device, scene.frame);
+  scene = Scene{};
+}
 
-  auto frame = anari::newObject<anari::Frame>(device);
-  std::thread initFrameThread([&]() {
-    initializeFrame(device, frame, world, renderer, camera);
-    fprintf(stdout, "%s\n", "frame initialization thread finished");
-  });
+// ========================================================
+// Image encoders: stb PNG (deflate), PNG with stored
+//  (uncompressed) deflate blocks, and QOI. Rows are read
+//  from first with a signed stride, so negative strides
+//  emit them bottom-up
+// ========================================================
+enum class ImageFormat
+{
+  PNG,
+  PNG_STORED,
+  QOI
+};
 
-  // Periodically query some extensions //
+static const char *imageFormatName(ImageFormat format)
+{
+  switch (format) {
+  case ImageFormat::PNG:
+    return "png";
+  case ImageFormat::PNG_STORED:
+    return "png-stored";
+  default:
+    return "qoi";
+  }
+}
 
-  std::atomic<bool> finish_queryExtension{false};
-  std::thread queryExtensionThread([&]() {
-    for (;;) {
-      bool res
-          = deviceHasExtension(library, "default", "ANARI_KHR_CAMERA_PERSPECTIVE");
-      if (!res) {
-        fprintf(stderr, "%s\n", "extension not found");
-      }
+static const char *imageFormatExtension(ImageFormat format)
+{
+  return format == ImageFormat::QOI ? "qoi" : "png";
+}
 
-      if (finish_queryExtension)
-        break;
+static bool parseImageFormat(const std::string &name, ImageFormat &format)
+{
+  for (auto f : {ImageFormat::PNG, ImageFormat::PNG_STORED, ImageFormat::QOI}) {
+    if (name == imageFormatName(f)) {
+      format = f;
+      return true;
     }
-    fprintf(stdout, "%s\n", "extension query thread finished");
-  });
-
-  // Periodically query world boudns //
+  }
+  return false;
+}
 
-  std::atomic<bool> finish_queryBoundsNoWait{false};
-  std::thread queryBoundsNoWaitThread([&]() {
-    for (;;) {
-      float bounds[6] = { 1e30f, 1e30f, 1e30f, -1e30f, -1e30f, -1e30f };
-      int res = anariGetProperty(device,
-                       world, "bounds",
-                       ANARI_FLOAT32_BOX3,
-                       bounds,
-                       sizeof(bounds),
-                       ANARI_NO_WAIT);
-
-      if (!res) {
-        fprintf(stderr, "%s\n", "bounds property (no wait) query unsuccessful");
-      }
+static void putBE32(std::vector<unsigned char> &out, uint32_t v)
+{
+  out.push_back(v >> 24);
+  out.push_back(v >> 16);
+  out.push_back(v >> 8);
+  out.push_back(v);
+}
 
-      if (finish_queryBoundsNoWait)
-        break;
+// Slicing-by-4 CRC-32 (as used by PNG chunks), 4 bytes per step
+static uint32_t crc32(const unsigned char *data, size_t len, uint32_t crc = 0)
+{
+  static const auto table = []() {
+    std::array<std::array<uint32_t, 256>, 4> t;
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++)
+        c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      t[0][n] = c;
     }
-    fprintf(stdout, "%s\n", "bounds query (no wait) thread finished");
-  });
-
-  std::atomic<bool> finish_queryBoundsWait{false};
-  std::thread queryBoundsWaitThread([&]() {
-    for (;;) {
-      float bounds[6] = { 1e30f, 1e30f, 1e30f, -1e30f, -1e30f, -1e30f };
-      int res = anariGetProperty(device,
-                       world, "bounds",
-                       ANARI_FLOAT32_BOX3,
-                       bounds,
-                       sizeof(bounds),
-                       ANARI_WAIT);
-
-      if (!res) {
-        fprintf(stderr, "%s\n", "bounds property (wait) query unsuccessful");
-      }
-
-      if (finish_queryBoundsWait)
-        break;
+    for (uint32_t n = 0; n < 256; n++) {
+      for (int k = 1; k < 4; k++)
+        t[k][n] = t[0][t[k - 1][n] & 0xff] ^ (t[k - 1][n] >> 8);
     }
-    fprintf(stdout, "%s\n", "bounds query (wait) thread finished");
-  });
+    return t;
+  }();
 
-  // Rendering //
-  std::thread renderThread([&]() {
-    for (int i=0; i<10; i++) {
-      std::stringstream str;
-      str << "out_" << i << ".png";
-      render(device, frame, str.str());
-    }
+  crc = ~crc;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    crc ^= uint32_t(data[i]) | uint32_t(data[i + 1]) << 8
+        | uint32_t(data[i + 2]) << 16 | uint32_t(data[i + 3]) << 24;
+    crc = table[3][crc & 0xff] ^ table[2][(crc >> 8) & 0xff]
+        ^ table[1][(crc >> 16) & 0xff] ^ table[0][crc >> 24];
+  }
+  for (; i < len; i++)
+    crc = table[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
 
-    // Tell the periodic query threads to finish:
-    finish_queryExtension = true;
-    finish_queryBoundsNoWait = true;
-    finish_queryBoundsWait = true;
+static std::vector<unsigned char> encodePNGStored(
+    const unsigned char *first, ptrdiff_t stride, uint32_t w, uint32_t h)
+{
+  const size_t rowBytes = size_t(w) * 4 + 1;
+  const size_t rawBytes = rowBytes * h;
+  const size_t idatBytes = 2 + rawBytes + (rawBytes / 65535 + 1) * 5 + 4;
 
-    fprintf(stdout, "%s\n", "render thread finished");
-  });
+  std::vector<unsigned char> out = {137, 80, 78, 71, 13, 10, 26, 10};
+  out.reserve(8 + 25 + 12 + idatBytes + 12);
 
-  // Join all threads //
+  auto chunk = [&](const char *type, const std::vector<unsigned char> &data) {
+    putBE32(out, uint32_t(data.size()));
+    const size_t begin = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putBE32(out, crc32(&out[begin], out.size() - begin));
+  };
 
-  renderThread.join();
-  queryBoundsWaitThread.join();
-  queryBoundsNoWaitThread.join();
-  queryExtensionThread.join();
-  initWorldThread.join();
-  initRendererThread.join();
-  initCameraThread.join();
-  initFrameThread.join();
+  std::vector<unsigned char> ihdr;
+  putBE32(ihdr, w);
+  putBE32(ihdr, h);
+  ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0}); // 8 bit RGBA, no interlace
+  chunk("IHDR", ihdr);
 
-  // Cleanup remaining ANARI objets //
+  // zlib stream of stored blocks over the filtered scanlines (filter 0)
 
-  anari::release(device, camera);
-  anari::release(device, renderer);
-  anari::release(device, world);
-  anari::release(device, frame);
-  anari::release(device, device);
+  std::vector<unsigned char> idat = {0x78, 0x01};
+  idat.reserve(idatBytes);
 
-  anari::unloadLibrary(library);
+  uint32_t s1 = 1, s2 = 0; // adler32
+  size_t blockLeft = 0;
+  size_t remaining = rawBytes;
+  auto emit = [&](const unsigned char *p, size_t n) {
+    while (n > 0) {
+      if (blockLeft == 0) {
+        blockLeft = std::min<size_t>(remaining, 65535);
+        remaining -= blockLeft;
+        const uint16_t len = uint16_t(blockLeft);
+        idat.insert(idat.end(),
+            {uint8_t(remaining == 0), uint8_t(len), uint8_t(len >> 8),
+                uint8_t(~len), uint8_t(~len >> 8)});
+      }
+      const size_t k = std::min(n, blockLeft);
+      idat.insert(idat.end(), p, p + k);
+      // 5552 bytes is the most that can be summed before s2 may overflow
+      for (size_t i = 0; i < k; i += 5552) {
+        const size_t end = std::min(k, i + 5552);
+        for (size_t j = i; j < end; j++) {
+          s1 += p[j];
+          s2 += s1;
+        }
+        s1 %= 65521;
+        s2 %= 65521;
+      }
+      p += k;
+      n -= k;
+      blockLeft -= k;
+    }
+  };
 
-  return 0;
+  const unsigned char filter = 0;
+  for (uint32_t y = 0; y < h; y++) {
+    emit(&filter, 1);
+    emit(first + y * stride, rowBytes - 1);
+  }
+  putBE32(idat, (s2 << 16) | s1);
+  chunk("IDAT", idat);
+  chunk("IEND", {});
+  return out;
+}
+
+// "Quite OK Image" format, see https://qoiformat.org/qoi-specification.pdf
+static std::vector<unsigned char> encodeQOI(
+    const unsigned char *first, ptrdiff_t stride, uint32_t w, uint32_t h)
+{
+  std::vector<unsigned char> out = {'q', 'o', 'i', 'f'};
+  out.reserve(14 + size_t(w) * h * 5 + 8);
+  putBE32(out, w);
+  putBE32(out, h);
+  out.push_back(4); // RGBA
+  out.push_back(0); // sRGB with linear alpha
+
+  struct RGBA
+  {
+    uint8_t r, g, b, a;
+    bool operator==(const RGBA &o) const
+    {
+      return r == o.r && g == o.g && b == o.b && a == o.a;
+    }
+  };
+  RGBA index[64] = {};
+  RGBA prev = {0, 0, 0, 255};
+  int run = 0;
+
+  for (uint32_t y = 0; y < h; y++) {
+    const unsigned char *row = first + y * stride;
+    for (uint32_t x = 0; x < w; x++) {
+      const RGBA px = {row[4 * x], row[4 * x + 1], row[4 * x + 2], row[4 * x + 3]};
+      if (px == prev) {
+        if (++run == 62) {
+          out.push_back(0xc0 | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+      if (run > 0) {
+        out.push_back(0xc0 | (run - 1));
+        run = 0;
+      }
+
+      const int hash = (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+      if (index[hash] == px) {
+        out.push_back(hash);
+      } else {
+        index[hash] = px;
+        if (px.a == prev.a) {
+          const int8_t dr = int8_t(px.r - prev.r);
+          const int8_t dg = int8_t(px.g - prev.g);
+          const int8_t db = int8_t(px.b - prev.b);
+          const int8_t drg = int8_t(dr - dg);
+          const int8_t dbg = int8_t(db - dg);
+          if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            out.push_back(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+          else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8
+              && dbg <= 7) {
+            out.push_back(0x80 | (dg + 32));
+            out.push_back((drg + 8) << 4 | (dbg + 8));
+          } else
+            out.insert(out.end(), {0xfe, px.r, px.g, px.b});
+        } else
+          out.insert(out.end(), {0xff, px.r, px.g, px.b, px.a});
+      }
+      prev = px;
+    }
+  }
+  if (run > 0)
+    out.push_back(0xc0 | (run - 1));
+  out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  return out;
+}
+
+// ========================================================
+// App-side conversion of float color (FLOAT32_VEC4) to
+//  RGBA8: exposure, tone map and sRGB encode on RGB, alpha
+//  only clamped. The SSE2 path converts 4 pixels per step
+// ========================================================
+enum class ToneMap
+{
+  NONE,
+  REINHARD,
+  ACES
+};
+
+static const char *toneMapName(ToneMap op)
+{
+  switch (op) {
+  case ToneMap::NONE:
+    return "none";
+  case ToneMap::REINHARD:
+    return "reinhard";
+  default:
+    return "aces";
+  }
+}
+
+static bool parseToneMap(const std::string &name, ToneMap &op)
+{
+  for (auto o : {ToneMap::NONE, ToneMap::REINHARD, ToneMap::ACES}) {
+    if (name == toneMapName(o)) {
+      op = o;
+      return true;
+    }
+  }
+  return false;
+}
+
+struct ToneMapParams
+{
+  ToneMap op{ToneMap::NONE};
+  float exposure{1.f};
+};
+
+// Exposed values are clamped to the largest half float first, so that
+// infinities saturate instead of turning into NaN inside the tone map
+static constexpr float kMaxExposed = 65504.f;
+
+// Clamp to [0,1]; NaN maps to 0, as with _mm_max_ps(x, 0) below
+static float saturate(float x)
+{
+  return x > 0.f ? std::min(x, 1.f) : 0.f;
+}
+
+static float toneMap(float x, ToneMap op)
+{
+  switch (op) {
+  case ToneMap::REINHARD:
+    return x / (1.f + x);
+  case ToneMap::ACES: // Narkowicz' fit of the ACES filmic curve
+    return x * (2.51f * x + 0.03f) / (x * (2.43f * x + 0.59f) + 0.14f);
+  default:
+    return x;
+  }
+}
+
+static float linearToSRGB(float x)
+{
+  return x <= 0.0031308f ? 12.92f * x
+                         : 1.055f * std::pow(x, 1.f / 2.4f) - 0.055f;
+}
+
+static void convertToRGBA8Scalar(const float4 *in,
+    uint32_t *out,
+    size_t begin,
+    size_t end,
+    const ToneMapParams &params)
+{
+  for (size_t i = begin; i < end; i++) {
+    uint32_t pixel = 0;
+    for (int c = 0; c < 3; c++) {
+      const float x = std::min(in[i][c] * params.exposure, kMaxExposed);
+      const float v = toneMap(x, params.op);
+      pixel |= uint32_t(linearToSRGB(saturate(v)) * 255.f + 0.5f) << (8 * c);
+    }
+    pixel |= uint32_t(saturate(in[i][3]) * 255.f + 0.5f) << 24;
+    out[i] = pixel;
+  }
+}
+
+#ifdef __SSE2__
+static __m128 toneMap(__m128 x, ToneMap op)
+{
+  switch (op) {
+  case ToneMap::REINHARD:
+    return _mm_div_ps(x, _mm_add_ps(_mm_set1_ps(1.f), x));
+  case ToneMap::ACES: {
+    const __m128 num = _mm_mul_ps(
+        x, _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.51f)), _mm_set1_ps(0.03f)));
+    const __m128 den = _mm_add_ps(
+        _mm_mul_ps(x,
+            _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(2.43f)), _mm_set1_ps(0.59f))),
+        _mm_set1_ps(0.14f));
+    return _mm_div_ps(num, den);
+  }
+  default:
+    return x;
+  }
+}
+
+// sRGB curve from three square roots instead of pow(), accurate to
+// well below one 8-bit step on [0,1]
+static __m128 linearToSRGB(__m128 x)
+{
+  const __m128 s1 = _mm_sqrt_ps(x);
+  const __m128 s2 = _mm_sqrt_ps(s1);
+  const __m128 s3 = _mm_sqrt_ps(s2);
+  __m128 hi = _mm_mul_ps(s1, _mm_set1_ps(0.662002687f));
+  hi = _mm_add_ps(hi, _mm_mul_ps(s2, _mm_set1_ps(0.684122060f)));
+  hi = _mm_sub_ps(hi, _mm_mul_ps(s3, _mm_set1_ps(0.323583601f)));
+  hi = _mm_sub_ps(hi, _mm_mul_ps(x, _mm_set1_ps(0.0225411470f)));
+  const __m128 lo = _mm_mul_ps(x, _mm_set1_ps(12.92f));
+  const __m128 useLo = _mm_cmple_ps(x, _mm_set1_ps(0.0031308f));
+  return _mm_or_ps(_mm_and_ps(useLo, lo), _mm_andnot_ps(useLo, hi));
+}
+#endif
+
+static void convertToRGBA8(const float4 *in,
+    uint32_t *out,
+    size_t begin,
+    size_t end,
+    const ToneMapParams &params)
+{
+  size_t i = begin;
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+  const __m128 exposure =
+      _mm_setr_ps(params.exposure, params.exposure, params.exposure, 1.f);
+  const __m128 alphaMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+  const __m128 scale = _mm_set1_ps(255.f);
+  const __m128 maxExposed = _mm_set1_ps(kMaxExposed);
+
+  auto convert = [&](const float4 &p) {
+    const __m128 v = _mm_loadu_ps(&p[0]);
+    const __m128 alpha = _mm_min_ps(_mm_max_ps(v, zero), one);
+    // min(max, x) rather than min(x, max) keeps NaN, like std::min above
+    __m128 c = _mm_min_ps(maxExposed, _mm_mul_ps(v, exposure));
+    c = toneMap(c, params.op);
+    c = linearToSRGB(_mm_min_ps(_mm_max_ps(c, zero), one));
+    c = _mm_or_ps(_mm_and_ps(alphaMask, alpha), _mm_andnot_ps(alphaMask, c));
+    return _mm_cvtps_epi32(_mm_mul_ps(c, scale));
+  };
+
+  for (; i + 4 <= end; i += 4) {
+    const __m128i p01 = _mm_packs_epi32(convert(in[i]), convert(in[i + 1]));
+    const __m128i p23 =
+        _mm_packs_epi32(convert(in[i + 2]), convert(in[i + 3]));
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(p01, p23));
+  }
+#endif
+  convertToRGBA8Scalar(in, out, i, end, params);
+}
+
+// ========================================================
+// Per-frame image statistics to validate frames: luminance
+//  histogram and mean, coverage (pixels that differ from
+//  the background) and NaN/Inf counts of float channels
+// ========================================================
+struct ImageStats
+{
+  static constexpr int kNumBins = 16;
+  uint64_t histogram[kNumBins]{};
+  double luminanceSum{0.0};
+  uint64_t numPixels{0};
+  uint64_t numFinite{0};
+  uint64_t numCovered{0};
+  uint64_t numNaN{0};
+  uint64_t numInf{0};
+
+  void merge(const ImageStats &other)
+  {
+    for (int b = 0; b < kNumBins; b++)
+      histogram[b] += other.histogram[b];
+    luminanceSum += other.luminanceSum;
+    numPixels += other.numPixels;
+    numFinite += other.numFinite;
+    numCovered += other.numCovered;
+    numNaN += other.numNaN;
+    numInf += other.numInf;
+  }
+};
+
+// RGBA8 channel: luma of the sRGB-encoded values (Rec. 709 weights in
+// 8-bit fixed point); covered if any of R, G, B is off by > tolerance
+static void accumulateImageStats(const uint32_t *pixels,
+    size_t begin,
+    size_t end,
+    uint32_t background,
+    ImageStats &stats)
+{
+  const int tolerance = 2;
+  auto add = [&](uint32_t luma, bool covered) {
+    stats.histogram[luma * ImageStats::kNumBins / 256]++;
+    stats.luminanceSum += luma / 255.0;
+    stats.numCovered += covered;
+  };
+
+  size_t i = begin;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weights = _mm_setr_epi16(54, 183, 19, 0, 54, 183, 19, 0);
+  const __m128i bg = _mm_set1_epi32(int(background));
+  const __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+  const __m128i tol = _mm_set1_epi8(char(tolerance));
+  alignas(16) uint32_t luma[4];
+
+  for (; i + 4 <= end; i += 4) {
+    const __m128i p = _mm_loadu_si128((const __m128i *)(pixels + i));
+
+    // (54R + 183G, 19B) per pixel, then add the pairs
+    const __m128 lo =
+        _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(p, zero), weights));
+    const __m128 hi =
+        _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(p, zero), weights));
+    const __m128i sum = _mm_add_epi32(
+        _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+        _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+    _mm_store_si128((__m128i *)luma, _mm_srli_epi32(sum, 8));
+
+    // |p - bg| per byte minus the tolerance is zero in RGB for background
+    const __m128i diff =
+        _mm_or_si128(_mm_subs_epu8(p, bg), _mm_subs_epu8(bg, p));
+    const __m128i over = _mm_and_si128(_mm_subs_epu8(diff, tol), rgbMask);
+    const int isBackground =
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(over, zero)));
+
+    for (int k = 0; k < 4; k++)
+      add(luma[k], !(isBackground >> k & 1));
+  }
+#endif
+  for (; i < end; i++) {
+    const uint32_t p = pixels[i];
+    bool covered = false;
+    for (int c = 0; c < 3; c++) {
+      const int d = int(p >> (8 * c) & 0xff) - int(background >> (8 * c) & 0xff);
+      covered |= std::abs(d) > tolerance;
+    }
+    add((54 * (p & 0xff) + 183 * (p >> 8 & 0xff) + 19 * (p >> 16 & 0xff)) >> 8,
+        covered);
+  }
+  stats.numPixels += end - begin;
+  stats.numFinite += end - begin;
+}
+
+// Float channel: linear luminance (clamped to [0,1] for the histogram
+// only); pixels with a NaN or Inf channel are counted but not accumulated
+static void accumulateImageStats(const float4 *pixels,
+    size_t begin,
+    size_t end,
+    const float4 &background,
+    ImageStats &stats)
+{
+  const float tolerance = 1e-3f;
+  auto add = [&](float luminance, bool covered) {
+    const int bin = int(saturate(luminance) * ImageStats::kNumBins);
+    stats.histogram[std::min(bin, ImageStats::kNumBins - 1)]++;
+    stats.luminanceSum += luminance;
+    stats.numFinite++;
+    stats.numCovered += covered;
+  };
+
+  size_t i = begin;
+#ifdef __SSE2__
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 inf = _mm_set1_ps(INFINITY);
+  const __m128 tol = _mm_set1_ps(tolerance);
+  alignas(16) float luminance[4];
+
+  for (; i + 4 <= end; i += 4) {
+    __m128 r = _mm_loadu_ps(&pixels[i][0]);
+    __m128 g = _mm_loadu_ps(&pixels[i + 1][0]);
+    __m128 b = _mm_loadu_ps(&pixels[i + 2][0]);
+    __m128 a = _mm_loadu_ps(&pixels[i + 3][0]);
+    _MM_TRANSPOSE4_PS(r, g, b, a);
+
+    const int nan =
+        _mm_movemask_ps(_mm_or_ps(_mm_cmpunord_ps(r, g), _mm_cmpunord_ps(b, a)));
+    auto isInf = [&](__m128 x) {
+      return _mm_cmpeq_ps(_mm_and_ps(x, absMask), inf);
+    };
+    const int infinite = _mm_movemask_ps(_mm_or_ps(
+        _mm_or_ps(isInf(r), isInf(g)), _mm_or_ps(isInf(b), isInf(a))));
+
+    auto differs = [&](__m128 x, float y) {
+      return _mm_cmpgt_ps(
+          _mm_and_ps(_mm_sub_ps(x, _mm_set1_ps(y)), absMask), tol);
+    };
+    const int covered = _mm_movemask_ps(_mm_or_ps(
+        _mm_or_ps(differs(r, background[0]), differs(g, background[1])),
+        differs(b, background[2])));
+
+    __m128 l = _mm_mul_ps(r, _mm_set1_ps(0.2126f));
+    l = _mm_add_ps(l, _mm_mul_ps(g, _mm_set1_ps(0.7152f)));
+    l = _mm_add_ps(l, _mm_mul_ps(b, _mm_set1_ps(0.0722f)));
+    _mm_store_ps(luminance, l);
+
+    for (int k = 0; k < 4; k++) {
+      stats.numNaN += nan >> k & 1;
+      stats.numInf += infinite >> k & 1;
+      if (!((nan | infinite) >> k & 1))
+        add(luminance[k], covered >> k & 1);
+    }
+  }
+#endif
+  for (; i < end; i++) {
+    const float4 &p = pixels[i];
+    bool nan = false, infinite = false, covered = false;
+    for (int c = 0; c < 4; c++) {
+      nan |= std::isnan(p[c]);
+      infinite |= std::isinf(p[c]);
+    }
+    for (int c = 0; c < 3; c++)
+      covered |= std::abs(p[c] - background[c]) > tolerance;
+    stats.numNaN += nan;
+    stats.numInf += infinite;
+    if (!nan && !infinite)
+      add(0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2], covered);
+  }
+  stats.numPixels += end - begin;
+}
+
+// One chunk per thread, each accumulated locally and merged at the end
+template <typename T, typename Background>
+static ImageStats computeImageStats(const T *pixels,
+    size_t numPixels,
+    const Background &background,
+    int numThreads)
+{
+  const size_t numChunks = std::max(1, numThreads);
+  std::vector<ImageStats> partial(numChunks);
+  parallelFor(numChunks, numThreads, [&](size_t b, size_t e) {
+    for (size_t c = b; c < e; c++) {
+      ImageStats local;
+      accumulateImageStats(pixels,
+          numPixels * c / numChunks,
+          numPixels * (c + 1) / numChunks,
+          background,
+          local);
+      partial[c] = local;
+    }
+  });
+
+  ImageStats stats;
+  for (const auto &p : partial)
+    stats.merge(p);
+  return stats;
+}
+
+static void printImageStats(const char *label, const ImageStats &stats)
+{
+  printf("%s: luminance %.3f, coverage %.1f%%, NaN %llu, Inf %llu, "
+         "histogram[%%]",
+      label,
+      stats.numFinite ? stats.luminanceSum / stats.numFinite : 0.0,
+      stats.numPixels ? 100.0 * stats.numCovered / stats.numPixels : 0.0,
+      (unsigned long long)stats.numNaN,
+      (unsigned long long)stats.numInf);
+  for (uint64_t count : stats.histogram)
+    printf(" %.0f", stats.numFinite ? 100.0 * count / stats.numFinite : 0.0);
+  printf("\n");
+}
+
+// Statistics of a frame's color channel, RGBA8 or FLOAT32_VEC4
+static ImageStats computeFrameStats(
+    anari::Device device, anari::Frame frame, int numThreads)
+{
+  auto fb = anari::map<uint32_t>(device, frame, "channel.color");
+  const size_t numPixels = size_t(fb.width) * fb.height;
+  ImageStats stats;
+  if (fb.pixelType == ANARI_FLOAT32_VEC4) {
+    stats = computeImageStats(
+        (const float4 *)fb.data, numPixels, backgroundColor, numThreads);
+  } else {
+    // The background as the device encodes it into the sRGB channel
+    uint32_t background = 0;
+    convertToRGBA8Scalar(&backgroundColor, &background, 0, 1, ToneMapParams{});
+    stats = computeImageStats(fb.data, numPixels, background, numThreads);
+  }
+  anari::unmap(device, frame, "channel.color");
+  return stats;
+}
+
+// ========================================================
+// Function to render a given frame (renderer+world+cam)
+//  and return the device-reported duration in seconds
+// ========================================================
+static float renderFrame(anari::Device device, anari::Frame frame)
+{
+  anari::render(device, frame);
+  anari::wait(device, frame);
+
+  float duration = 0.f;
+  anari::getProperty(device, frame, "duration", duration, ANARI_NO_WAIT);
+  return duration;
+}
+
+// ========================================================
+// Functions to write images and the color channel of a frame to disk
+// ========================================================
+// Rows are bottom-up (origin in the lower left, as in ANARI frames); they
+// are emitted in reverse straight from 'pixels' with a negative stride, so
+// no copy is made and stb's process-global flip flag is never touched.
+static std::vector<unsigned char> encodeImage(const unsigned char *pixels,
+    uint32_t w,
+    uint32_t h,
+    ImageFormat format)
+{
+  const ptrdiff_t stride = -ptrdiff_t(4 * w);
+  const auto *lastRow = pixels + size_t(h - 1) * 4 * w;
+  if (format == ImageFormat::QOI)
+    return encodeQOI(lastRow, stride, w, h);
+  if (format == ImageFormat::PNG_STORED)
+    return encodePNGStored(lastRow, stride, w, h);
+
+  int len = 0;
+  unsigned char *png =
+      stbi_write_png_to_mem(lastRow, int(stride), int(w), int(h), 4, &len);
+  std::vector<unsigned char> encoded(png, png + len);
+  STBIW_FREE(png);
+  return encoded;
+}
+
+static void writeImage(const std::string &fileName,
+    const unsigned char *pixels,
+    uint32_t w,
+    uint32_t h,
+    ImageFormat format = ImageFormat::PNG)
+{
+  auto begin = Clock::now();
+  const auto encoded = encodeImage(pixels, w, h, format);
+  const double encodeMS = elapsedMS(begin, Clock::now());
+
+  if (FILE *fp = fopen(fileName.c_str(), "wb")) {
+    fwrite(encoded.data(), 1, encoded.size(), fp);
+    fclose(fp);
+  } else {
+    fprintf(stderr, "could not write %s\n", fileName.c_str());
+    return;
+  }
+
+  printf("Output: %s (%s, %.1f KB, encoded in %.3fms)\n",
+      fileName.c_str(),
+      imageFormatName(format),
+      encoded.size() / 1024.0,
+      encodeMS);
+}
+
+static void writeFrame(anari::Device device,
+    anari::Frame frame,
+    const std::string &fileName,
+    ImageFormat format = ImageFormat::PNG)
+{
+  auto fb = anari::map<uint32_t>(device, frame, "channel.color");
+  writeImage(
+      fileName, (const unsigned char *)fb.data, fb.width, fb.height, format);
+  anari::unmap(device, frame, "channel.color");
+}
+
+// ========================================================
+// Preview pyramids: 2x2 box-filtered mip levels of each
+//  frame, built and written by worker threads. Only the
+//  first reduction, which doubles as the copy out of the
+//  mapped frame, runs on the render thread
+// ========================================================
+struct PreviewImage
+{
+  std::vector<uint32_t> pixels;
+  uint32_t width{0};
+  uint32_t height{0};
+};
+
+// Rounded-up byte-wise average, as computed by _mm_avg_epu8
+static uint32_t averageRGBA8(uint32_t a, uint32_t b)
+{
+  return (a | b) - (((a ^ b) >> 1) & 0x7f7f7f7fu);
+}
+
+// Halve both dimensions (an odd last row/column is dropped), averaging
+// row pairs first and then column pairs
+static PreviewImage downsample(const uint32_t *src, uint32_t w, uint32_t h)
+{
+  PreviewImage dst;
+  dst.width = std::max(1u, w / 2);
+  dst.height = std::max(1u, h / 2);
+  dst.pixels.resize(size_t(dst.width) * dst.height);
+
+  for (uint32_t y = 0; y < dst.height; y++) {
+    const uint32_t *row0 = src + size_t(std::min(2 * y, h - 1)) * w;
+    const uint32_t *row1 = src + size_t(std::min(2 * y + 1, h - 1)) * w;
+    uint32_t *out = dst.pixels.data() + size_t(y) * dst.width;
+    uint32_t x = 0;
+#ifdef __SSE2__
+    for (; x + 4 <= w / 2; x += 4) {
+      const __m128 a = _mm_castsi128_ps(
+          _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(row0 + 2 * x)),
+              _mm_loadu_si128((const __m128i *)(row1 + 2 * x))));
+      const __m128 b = _mm_castsi128_ps(
+          _mm_avg_epu8(_mm_loadu_si128((const __m128i *)(row0 + 2 * x + 4)),
+              _mm_loadu_si128((const __m128i *)(row1 + 2 * x + 4))));
+      const __m128i even =
+          _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      const __m128i odd =
+          _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      _mm_storeu_si128((__m128i *)(out + x), _mm_avg_epu8(even, odd));
+    }
+#endif
+    for (; x < dst.width; x++) {
+      const uint32_t x0 = std::min(2 * x, w - 1);
+      const uint32_t x1 = std::min(2 * x + 1, w - 1);
+      out[x] = averageRGBA8(averageRGBA8(row0[x0], row1[x0]),
+          averageRGBA8(row0[x1], row1[x1]));
+    }
+  }
+  return dst;
+}
+
+struct PreviewWriter
+{
+  struct Job
+  {
+    std::string fileName;
+    PreviewImage level1;
+    PreviewImage full; // sampled frames only, encoded for comparison
+  };
+
+  // Every other frame, up to this many, also carries a full-size copy
+  static constexpr int kFullSamples = 4;
+
+  int level{1};
+  ImageFormat format{ImageFormat::PNG};
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<Job> jobs;
+  bool finish{false};
+  std::vector<std::thread> threads;
+  std::vector<double> submitMS, workerMS, fullEncodeMS;
+  int numSubmitted{0};
+  int numFullCopies{0};
+  uint32_t previewSize[2]{0, 0};
+
+  void start(int previewLevel, ImageFormat imageFormat, int numWorkers)
+  {
+    level = std::max(1, previewLevel);
+    format = imageFormat;
+    finish = false;
+    for (int t = 0; t < numWorkers; t++)
+      threads.emplace_back([this]() {
+        setThreadRole("previewWorkerThread");
+        work();
+      });
+  }
+
+  // Render thread: reduce the mapped frame to level 1 and queue it
+  void submit(
+      anari::Device device, anari::Frame frame, const std::string &fileName)
+  {
+    auto begin = Clock::now();
+    Job job;
+    job.fileName = fileName;
+    auto fb = anari::map<uint32_t>(device, frame, "channel.color");
+    job.level1 = downsample(fb.data, fb.width, fb.height);
+    const bool sampled =
+        numFullCopies < kFullSamples && numSubmitted++ % 2 == 0;
+    if (sampled) {
+      numFullCopies++;
+      job.full.width = fb.width;
+      job.full.height = fb.height;
+      job.full.pixels.assign(fb.data, fb.data + size_t(fb.width) * fb.height);
+    }
+    anari::unmap(device, frame, "channel.color");
+    if (!sampled) // sampled frames pay for the extra full-size copy
+      submitMS.push_back(elapsedMS(begin, Clock::now()));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+    cond.notify_one();
+  }
+
+  void work()
+  {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() { return finish || !jobs.empty(); });
+        if (jobs.empty())
+          return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+
+      if (!job.full.pixels.empty()) {
+        auto begin = Clock::now();
+        encodeImage((const unsigned char *)job.full.pixels.data(),
+            job.full.width,
+            job.full.height,
+            format);
+        const double ms = elapsedMS(begin, Clock::now());
+        std::lock_guard<std::mutex> lock(mutex);
+        fullEncodeMS.push_back(ms);
+      }
+
+      auto begin = Clock::now();
+      PreviewImage image = std::move(job.level1);
+      for (int l = 1; l < level && (image.width > 1 || image.height > 1); l++)
+        image = downsample(image.pixels.data(), image.width, image.height);
+      writeImage(job.fileName,
+          (const unsigned char *)image.pixels.data(),
+          image.width,
+          image.height,
+          format);
+      const double ms = elapsedMS(begin, Clock::now());
+
+      std::lock_guard<std::mutex> lock(mutex);
+      workerMS.push_back(ms);
+      previewSize[0] = image.width;
+      previewSize[1] = image.height;
+    }
+  }
+
+  // Drain the queue, join the workers and report the cost per frame
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finish = true;
+      cond.notify_all();
+    }
+    for (auto &t : threads)
+      t.join();
+    threads.clear();
+
+    const double previewMS = computeStats(workerMS).mean;
+    const double encodeMS = computeStats(fullEncodeMS).mean;
+    printf("previews: level %d (%ux%u), workers %.3fms/frame\n",
+        level,
+        previewSize[0],
+        previewSize[1],
+        previewMS);
+    if (submitMS.empty()) {
+      // Every frame carried a full-size copy, so none shows the plain cost
+      printf("full-size %s encoding: %.3fms/frame (%zu frames), render "
+             "thread n/a -> saved n/a\n",
+          imageFormatName(format),
+          encodeMS,
+          fullEncodeMS.size());
+      return;
+    }
+    const double renderThreadMS = computeStats(submitMS).mean;
+    printf("full-size %s encoding: %.3fms/frame (%zu frames), render "
+           "thread %.3fms/frame (%zu frames) -> %.3fms saved\n",
+        imageFormatName(format),
+        encodeMS,
+        fullEncodeMS.size(),
+        renderThreadMS,
+        submitMS.size(),
+        encodeMS - renderThreadMS);
+  }
+};
+
+// ========================================================
+// Function to render a given frame (renderer+world+cam)
+//  and (optionally) produce an output image
+// ========================================================
+static void render(anari::Device device,
+    anari::Frame frame,
+    const std::string &fileName,
+    ImageFormat format = ImageFormat::PNG,
+    int statsThreads = 0,
+    PreviewWriter *preview = nullptr)
+{
+  // Render frame and print out duration property //
+
+  float duration = renderFrame(device, frame);
+
+  printf("rendered frame in %fms\n", duration * 1000);
+
+  // Optionally validate the frame (statsThreads > 0) //
+
+  if (statsThreads > 0) {
+    auto begin = Clock::now();
+    const auto stats = computeFrameStats(device, frame, statsThreads);
+    char label[64];
+    snprintf(label, sizeof(label), "frame stats (%.3fms)",
+        elapsedMS(begin, Clock::now()));
+    printImageStats(label, stats);
+  }
+
+  if (!fileName.empty() && preview)
+    preview->submit(device, frame, fileName);
+  else if (!fileName.empty())
+    writeFrame(device, frame, fileName, format);
+}
+
+// ========================================================
+// Periodic background activities competing with rendering
+// ========================================================
+static void queryExtensionLoop(anari::Library library,
+    const std::string &deviceSubtype,
+    const std::atomic<bool> &finish)
+{
+  for (;;) {
+    bool res = deviceHasExtension(
+        library, deviceSubtype, "ANARI_KHR_CAMERA_PERSPECTIVE");
+    if (!res) {
+      fprintf(stderr, "%s\n", "extension not found");
+    }
+
+    if (finish)
+      break;
+  }
+}
+
+static void queryBoundsLoop(anari::Device device,
+    anari::World world,
+    ANARIWaitMask waitMask,
+    const std::atomic<bool> &finish)
+{
+  for (;;) {
+    float bounds[6] = { 1e30f, 1e30f, 1e30f, -1e30f, -1e30f, -1e30f };
+    int res = anariGetProperty(device,
+                     world, "bounds",
+                     ANARI_FLOAT32_BOX3,
+                     bounds,
+                     sizeof(bounds),
+                     waitMask);
+
+    if (!res) {
+      fprintf(stderr, "bounds property (%s) query unsuccessful\n",
+          waitMask == ANARI_WAIT ? "wait" : "no wait");
+    }
+
+    if (finish)
+      break;
+  }
+}
+
+// Re-commit the camera with unchanged parameters, like a UI that pushes
+// camera state every event without checking whether anything changed
+static void commitCameraLoop(
+    anari::Device device, anari::Camera camera, const std::atomic<bool> &finish)
+{
+  for (;;) {
+    initializeCamera(device, camera);
+
+    if (finish)
+      break;
+  }
+}
+
+// ========================================================
+// Thread priorities (per thread: nice value or RT policy)
+// ========================================================
+struct ThreadPriority
+{
+  std::string policy{"default"}; // default | nice | batch | idle | fifo | rr
+  int value{0}; // nice value for nice/batch, priority for fifo/rr
+};
+
+static bool parseThreadPriority(const std::string &spec, ThreadPriority &p)
+{
+  const auto colon = spec.find(':');
+  p.policy = spec.substr(0, colon);
+  p.value = colon == std::string::npos ? 0 : std::atoi(&spec[colon + 1]);
+  return p.policy == "default" || p.policy == "nice" || p.policy == "batch"
+      || p.policy == "idle" || p.policy == "fifo" || p.policy == "rr";
+}
+
+static std::string threadPriorityLabel(const ThreadPriority &p)
+{
+  if (p.policy == "default" || p.policy == "idle")
+    return p.policy;
+  return p.policy + ':' + std::to_string(p.value);
+}
+
+// Applies to the calling thread only; returns false if the OS refused
+// (raising priority usually needs CAP_SYS_NICE or an RLIMIT_RTPRIO/NICE).
+// "default" explicitly resets to SCHED_OTHER/nice 0, as new threads inherit
+// the policy of their creator (e.g. a SCHED_FIFO render thread)
+static bool applyThreadPriority(const ThreadPriority &p)
+{
+#ifdef __linux__
+  sched_param param{};
+  int policy = SCHED_OTHER;
+  if (p.policy == "fifo" || p.policy == "rr") {
+    policy = p.policy == "fifo" ? SCHED_FIFO : SCHED_RR;
+    param.sched_priority = p.value;
+  } else if (p.policy == "batch")
+    policy = SCHED_BATCH;
+  else if (p.policy == "idle")
+    policy = SCHED_IDLE;
+
+  if (pthread_setschedparam(pthread_self(), policy, &param) != 0)
+    return false;
+
+  // On Linux the nice value is a per-thread attribute
+  if (policy == SCHED_OTHER || policy == SCHED_BATCH) {
+    const id_t tid = id_t(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, p.value) != 0)
+      return false;
+  }
+  return true;
+#else
+  return p.policy == "default";
+#endif
+}
+
+// ========================================================
+// Command line options
+// ========================================================
+struct Options
+{
+  std::string mode{"default"};
+  std::string libraryName{"environment"};
+  std::string deviceSubtype{"default"};
+  int numFrames{10};
+  int numWarmupFrames{2};
+  int numBackgroundThreads{int(std::max(1u, std::thread::hardware_concurrency()))};
+  size_t backgroundBufferMB{64};
+  int socket{-1};
+  ThreadPriority renderPriority{"nice", -10};
+  ThreadPriority queryPriority{"nice", 10};
+  double frameIntervalMS{1000.0 / 60.0};
+  double budgetMS{1000.0 / 60.0};
+  std::string adaptKnob{"both"};
+  int numTiles{4};
+  int numProcesses{2};
+  std::string sharedName{"/anari-framebuffer"};
+  int numSharedSlots{3};
+  int numSwaps{5};
+  uint32_t numSpheres{10000};
+  int numTimesteps{16};
+  int numLODLevels{4};
+  ObjectArrayPath surfaceArrayPath{ObjectArrayPath::NEW_AND_MAP};
+  int numThreads{int(std::max(1u, std::thread::hardware_concurrency()))};
+  ImageFormat imageFormat{ImageFormat::PNG};
+  ToneMapParams toneMap;
+  bool frameStats{false};
+  int previewLevel{0};
+  int numViews{12};
+  float eyeSeparation{0.065f};
+};
+
+static void printUsage(const char *argv0)
+{
+  printf("Usage: %s [options]\n", argv0);
+  printf("  --mode <name>       default | interference | oversubscribe |\n"
+         "                      scaling | priority | paced | adaptive |\n"
+         "                      tiles | sortlast | shm | worldswap |\n"
+         "                      playback | lod | surfaces | arraypaths |\n"
+         "                      quantized | tonemap | roi | views |\n"
+         "                      cameras | introspection\n");
+  printf("  --library <name>    ANARI library to load (default: environment)\n");
+  printf("  --device <subtype>  ANARI device subtype (default: default)\n");
+  printf("  --frames <n>        frames rendered per measurement (default: 10)\n");
+  printf("  --warmup <n>        untimed frames before measuring (default: 2)\n");
+  printf("  --format <f>        output images: png | png-stored | qoi (default: png)\n");
+  printf("  --threads <n>       worker threads for app-side processing (default: #cores)\n");
+  printf("  --bg-threads <n>    competing workload threads (default: #cores)\n");
+  printf("  --bg-buffer-mb <n>  per-thread buffer of the memory workload (default: 64)\n");
+  printf("  --socket <id>       restrict the scaling sweep to one socket\n");
+  printf("  --render-priority <p>  raised render thread priority (default: nice:-10)\n");
+  printf("  --query-priority <p>   lowered query thread priority (default: nice:10)\n");
+  printf("                      <p> = default | nice:<n> | batch:<n> | idle |\n"
+         "                            fifo:<prio> | rr:<prio>\n");
+  printf("  --interval-ms <t>   paced mode frame interval (default: 16.667)\n");
+  printf("  --budget-ms <t>     adaptive mode frame-time budget (default: 16.667)\n");
+  printf("  --adapt <knob>      samples | size | both (default: both)\n");
+  printf("  --tiles <k>         number of image strips in tiles mode (default: 4)\n");
+  printf("  --procs <n>         renderer processes in sortlast mode (default: 2)\n");
+  printf("  --shm-name <name>   shared memory ring name (default: /anari-framebuffer)\n");
+  printf("  --shm-slots <n>     frames in the shared memory ring (default: 3)\n");
+  printf("  --swaps <n>         world swaps in worldswap mode (default: 5)\n");
+  printf("  --spheres <n>       sphere count for modes that generate their own data\n"
+         "                      (default: 10000)\n");
+  printf("  --timesteps <n>     timesteps in playback mode (default: 16)\n");
+  printf("  --lod-levels <n>    levels (1/4 of the spheres each) in lod mode (default: 4)\n");
+  printf("  --array-path <p>    default mode world surface array: map | appmem | param\n");
+  printf("  --tonemap <op>      tonemap mode operator: none | reinhard | aces (default: none)\n");
+  printf("  --exposure <f>      tonemap mode exposure scale (default: 1)\n");
+  printf("  --frame-stats       log luminance/coverage/NaN statistics of every\n"
+         "                      default mode frame\n");
+  printf("  --preview-level <n> write default mode frames as mip level n previews\n"
+         "                      (1/2^n size), built on --threads workers (default: 0)\n");
+  printf("  --views <n>         largest view count in views mode (default: 12)\n");
+  printf("  --eye-sep <d>       views mode camera spacing (default: 0.065)\n");
+}
+
+static bool parseCommandLine(int argc, char *argv[], Options &opts)
+{
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    auto nextArg = [&]() -> const char * {
+      if (i + 1 >= argc) {
+        fprintf(stderr, "missing value for %s\n", arg.c_str());
+        return nullptr;
+      }
+      return argv[++i];
+    };
+
+    const char *value = nullptr;
+    if (arg == "-h" || arg == "--help") {
+      printUsage(argv[0]);
+      std::exit(0);
+    } else if (arg == "--mode" && (value = nextArg()))
+      opts.mode = value;
+    else if (arg == "--library" && (value = nextArg()))
+      opts.libraryName = value;
+    else if (arg == "--device" && (value = nextArg()))
+      opts.deviceSubtype = value;
+    else if (arg == "--frames" && (value = nextArg()))
+      opts.numFrames = std::max(1, std::atoi(value));
+    else if (arg == "--warmup" && (value = nextArg()))
+      opts.numWarmupFrames = std::max(0, std::atoi(value));
+    else if (arg == "--format" && (value = nextArg())
+        && parseImageFormat(value, opts.imageFormat))
+      ;
+    else if (arg == "--threads" && (value = nextArg()))
+      opts.numThreads = std::max(1, std::atoi(value));
+    else if (arg == "--bg-threads" && (value = nextArg()))
+      opts.numBackgroundThreads = std::max(1, std::atoi(value));
+    else if (arg == "--bg-buffer-mb" && (value = nextArg()))
+      opts.backgroundBufferMB = std::max(1, std::atoi(value));
+    else if (arg == "--socket" && (value = nextArg()))
+      opts.socket = std::atoi(value);
+    else if (arg == "--render-priority" && (value = nextArg())
+        && parseThreadPriority(value, opts.renderPriority))
+      ;
+    else if (arg == "--query-priority" && (value = nextArg())
+        && parseThreadPriority(value, opts.queryPriority))
+      ;
+    else if (arg == "--interval-ms" && (value = nextArg()))
+      opts.frameIntervalMS = std::max(0.1, std::atof(value));
+    else if (arg == "--budget-ms" && (value = nextArg()))
+      opts.budgetMS = std::max(0.1, std::atof(value));
+    else if (arg == "--adapt" && (value = nextArg())
+        && (!strcmp(value, "samples") || !strcmp(value, "size")
+            || !strcmp(value, "both")))
+      opts.adaptKnob = value;
+    else if (arg == "--tiles" && (value = nextArg()))
+      opts.numTiles = std::max(1, std::atoi(value));
+    else if (arg == "--procs" && (value = nextArg()))
+      opts.numProcesses = std::clamp(std::atoi(value), 1, 64);
+    else if (arg == "--shm-name" && (value = nextArg()))
+      opts.sharedName = value;
+    else if (arg == "--shm-slots" && (value = nextArg()))
+      opts.numSharedSlots = std::max(1, std::atoi(value));
+    else if (arg == "--swaps" && (value = nextArg()))
+      opts.numSwaps = std::max(1, std::atoi(value));
+    else if (arg == "--spheres" && (value = nextArg()))
+      opts.numSpheres = uint32_t(std::max(1ll, std::atoll(value)));
+    else if (arg == "--timesteps" && (value = nextArg()))
+      opts.numTimesteps = std::max(1, std::atoi(value));
+    else if (arg == "--lod-levels" && (value = nextArg()))
+      opts.numLODLevels = std::max(1, std::atoi(value));
+    else if (arg == "--array-path" && (value = nextArg())
+        && parseObjectArrayPath(value, opts.surfaceArrayPath))
+      ;
+    else if (arg == "--tonemap" && (value = nextArg())
+        && parseToneMap(value, opts.toneMap.op))
+      ;
+    else if (arg == "--exposure" && (value = nextArg()))
+      opts.toneMap.exposure = std::max(0.f, float(std::atof(value)));
+    else if (arg == "--frame-stats")
+      opts.frameStats = true;
+    else if (arg == "--preview-level" && (value = nextArg()))
+      opts.previewLevel = std::clamp(std::atoi(value), 0, 16);
+    else if (arg == "--views" && (value = nextArg()))
+      opts.numViews = std::clamp(std::atoi(value), 1, 64);
+    else if (arg == "--eye-sep" && (value = nextArg()))
+      opts.eyeSeparation = float(std::atof(value));
+    else {
+      if (!value)
+        fprintf(stderr, "unknown or incomplete option: %s\n", arg.c_str());
+      else
+        fprintf(stderr, "invalid value for %s: %s\n", arg.c_str(), value);
+      printUsage(argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+// ========================================================
+// Interference matrix: render alone and with every
+//  combination of concurrent activities (2^k factorial)
+// ========================================================
+enum InterferenceFactor
+{
+  FACTOR_EXTENSIONS = 0,
+  FACTOR_BOUNDS_WAIT,
+  FACTOR_BOUNDS_NO_WAIT,
+  FACTOR_COMMITS,
+  FACTOR_READBACK,
+  NUM_INTERFERENCE_FACTORS
+};
+
+static const char *interferenceFactorName(int factor)
+{
+  static const char *names[NUM_INTERFERENCE_FACTORS] = {
+      "extensions", "bounds-wait", "bounds-no-wait", "commits", "readback"};
+  return names[factor];
+}
+
+static std::string interferenceLabel(unsigned mask)
+{
+  if (mask == 0)
+    return "render alone";
+
+  std::string label;
+  for (int f = 0; f < NUM_INTERFERENCE_FACTORS; f++) {
+    if (mask & (1u << f)) {
+      if (!label.empty())
+        label += '+';
+      label += interferenceFactorName(f);
+    }
+  }
+  return label;
+}
+
+// Background threads for a set of InterferenceFactor bits (readback is
+// done by the render loop itself and therefore not started here)
+struct ConcurrentActivities
+{
+  std::atomic<bool> finish{false};
+  std::vector<std::thread> threads;
+
+  void start(const Options &opts,
+      anari::Library library,
+      anari::Device device,
+      const Scene &scene,
+      unsigned mask,
+      const ThreadPriority &priority = {})
+  {
+    finish = false;
+
+    auto startThread = [&](const char *role, auto loop) {
+      threads.emplace_back([priority, role, loop]() {
+        setThreadRole(role);
+        if (!applyThreadPriority(priority)) {
+          fprintf(stderr, "could not set query thread priority %s\n",
+              threadPriorityLabel(priority).c_str());
+        }
+        loop();
+      });
+    };
+
+    const std::string *subtype = &opts.deviceSubtype;
+    const std::atomic<bool> *done = &finish;
+    anari::World world = scene.world;
+    anari::Camera camera = scene.camera;
+
+    if (mask & (1u << FACTOR_EXTENSIONS)) {
+      startThread("queryExtensionThread",
+          [=]() { queryExtensionLoop(library, *subtype, *done); });
+    }
+    if (mask & (1u << FACTOR_BOUNDS_WAIT)) {
+      startThread("queryBoundsWaitThread",
+          [=]() { queryBoundsLoop(device, world, ANARI_WAIT, *done); });
+    }
+    if (mask & (1u << FACTOR_BOUNDS_NO_WAIT)) {
+      startThread("queryBoundsNoWaitThread",
+          [=]() { queryBoundsLoop(device, world, ANARI_NO_WAIT, *done); });
+    }
+    if (mask & (1u << FACTOR_COMMITS)) {
+      startThread("commitCameraThread",
+          [=]() { commitCameraLoop(device, camera, *done); });
+    }
+  }
+
+  void stop()
+  {
+    finish = true;
+    for (auto &t : threads)
+      t.join();
+    threads.clear();
+  }
+};
+
+static std::vector<double> measureWithActivities(const Options &opts,
+    anari::Library library,
+    anari::Device device,
+    const Scene &scene,
+    unsigned mask,
+    const ThreadPriority &queryPriority = {},
+    double minMS = 0.0) // keep rendering past numFrames until this is covered
+{
+  ConcurrentActivities activities;
+  activities.start(opts, library, device, scene, mask, queryPriority);
+  const bool readback = mask & (1u << FACTOR_READBACK);
+
+  std::vector<uint32_t> hostPixels;
+  std::vector<double> frameTimes;
+  double measuredMS = 0.0;
+  for (int i = 0;
+       i < opts.numWarmupFrames + opts.numFrames || measuredMS < minMS;
+       i++) {
+    auto begin = Clock::now();
+    renderFrame(device, scene.frame);
+    if (readback) {
+      auto fb = anari::map<uint32_t>(device, scene.frame, "channel.color");
+      hostPixels.assign(fb.data, fb.data + size_t(fb.width) * fb.height);
+      anari::unmap(device, scene.frame, "channel.color");
+    }
+    auto end = Clock::now();
+
+    if (i >= opts.numWarmupFrames) {
+      frameTimes.push_back(elapsedMS(begin, end));
+      measuredMS += frameTimes.back();
+    }
+  }
+
+  activities.stop();
+
+  return frameTimes;
+}
+
+static void runInterferenceMatrix(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const unsigned numCombinations = 1u << NUM_INTERFERENCE_FACTORS;
+  std::vector<double> meanFrameTime(numCombinations);
+
+  printf("%-56s %10s %10s %10s %10s\n",
+      "combination", "mean[ms]", "p95[ms]", "max[ms]", "delta[ms]");
+  for (unsigned mask = 0; mask < numCombinations; mask++) {
+    auto stats = computeStats(
+        measureWithActivities(opts, library, device, scene, mask));
+    meanFrameTime[mask] = stats.mean;
+    printf("%-56s %10.3f %10.3f %10.3f %+10.3f\n",
+        interferenceLabel(mask).c_str(),
+        stats.mean,
+        stats.p95,
+        stats.max,
+        stats.mean - meanFrameTime[0]);
+  }
+
+  // Main effect of a factor: mean frame time over all combinations with
+  // the factor enabled minus the mean over all combinations without it
+
+  struct Effect
+  {
+    int factor;
+    double alone;
+    double main;
+  };
+  std::vector<Effect> effects;
+  for (int f = 0; f < NUM_INTERFERENCE_FACTORS; f++) {
+    double with = 0.0, without = 0.0;
+    for (unsigned mask = 0; mask < numCombinations; mask++) {
+      if (mask & (1u << f))
+        with += meanFrameTime[mask];
+      else
+        without += meanFrameTime[mask];
+    }
+    const double half = numCombinations / 2;
+    effects.push_back({f,
+        meanFrameTime[1u << f] - meanFrameTime[0],
+        (with - without) / half});
+  }
+
+  std::sort(effects.begin(), effects.end(), [](const Effect &a, const Effect &b) {
+    return a.main > b.main;
+  });
+
+  printf("\nfactor effects on frame time (largest first)\n");
+  printf("%-16s %14s %14s\n", "factor", "alone[ms]", "main[ms]");
+  for (const auto &e : effects) {
+    printf("%-16s %+14.3f %+14.3f\n",
+        interferenceFactorName(e.factor), e.alone, e.main);
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Oversubscription: render while an application workload
+//  competes for the same cores
+// ========================================================
+struct alignas(64) WorkerProgress
+{
+  std::atomic<uint64_t> units{0};
+};
+
+struct CompetingWorkload
+{
+  std::string kind; // "cpu" or "memory"
+  size_t bufferBytes{0};
+  std::vector<WorkerProgress> progress;
+  std::vector<std::thread> threads;
+  std::atomic<bool> finish{false};
+  std::atomic<int> numReady{0};
+  std::atomic<bool> go{false};
+  Clock::time_point begin;
+
+  CompetingWorkload(const std::string &k, int numThreads, size_t bytes)
+      : kind(k), bufferBytes(bytes), progress(numThreads)
+  {}
+
+  // Workers set up (allocate and first-touch their buffers) before the
+  // clock starts, so page faults don't count as time without progress
+  void start()
+  {
+    finish = false;
+    go = false;
+    numReady = 0;
+    for (auto &p : progress)
+      p.units = 0;
+    for (size_t i = 0; i < progress.size(); i++) {
+      if (kind == "memory")
+        threads.emplace_back([this, i]() {
+          setThreadRole("memoryBoundThread");
+          memoryBound(progress[i]);
+        });
+      else
+        threads.emplace_back([this, i]() {
+          setThreadRole("cpuBoundThread");
+          cpuBound(progress[i]);
+        });
+    }
+    while (numReady < int(progress.size()))
+      std::this_thread::yield();
+    begin = Clock::now();
+    go = true;
+  }
+
+  void ready()
+  {
+    numReady++;
+    while (!go)
+      std::this_thread::yield();
+  }
+
+  // Returns the progress rate of each worker in units per second
+  std::vector<double> stop()
+  {
+    finish = true;
+    for (auto &t : threads)
+      t.join();
+    threads.clear();
+    const double seconds = elapsedMS(begin, Clock::now()) / 1000.0;
+    std::vector<double> rates;
+    for (auto &p : progress)
+      rates.push_back(p.units / seconds);
+    return rates;
+  }
+
+  // Dependent FP chain that never touches memory; one unit = 1M iterations
+  void cpuBound(WorkerProgress &p)
+  {
+    volatile float sink = 0.f;
+    float x = 1.f;
+    ready();
+    while (!finish) {
+      for (int i = 0; i < 1000000; i++)
+        x = std::sqrt(x * 1.000001f + 0.5f);
+      sink = x;
+      p.units++;
+    }
+    (void)sink;
+  }
+
+  // STREAM-like triad over a private buffer; one unit = one byte moved,
+  // credited per block so that short windows still see progress
+  void memoryBound(WorkerProgress &p)
+  {
+    const size_t n = std::max<size_t>(bufferBytes / (3 * sizeof(float)), 1);
+    const size_t block = (1 << 20) / (3 * sizeof(float)); // 1 MB moved
+    std::vector<float> a(n, 0.f), b(n, 1.f), c(n, 2.f);
+    ready();
+    while (!finish) {
+      for (size_t first = 0; first < n && !finish; first += block) {
+        const size_t last = std::min(n, first + block);
+        for (size_t i = first; i < last; i++)
+          a[i] = b[i] + 3.f * c[i];
+        p.units += 3 * (last - first) * sizeof(float);
+      }
+      std::swap(a, b);
+    }
+  }
+};
+
+// Jain's fairness index: 1 when all participants progress equally,
+// 1/n when a single participant gets everything
+static double jainFairness(const std::vector<double> &x)
+{
+  double sum = 0.0, sumSq = 0.0;
+  for (double v : x) {
+    sum += v;
+    sumSq += v * v;
+  }
+  return sumSq > 0.0 ? (sum * sum) / (x.size() * sumSq) : 0.0;
+}
+
+static void runOversubscription(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const unsigned activities = (1u << FACTOR_EXTENSIONS)
+      | (1u << FACTOR_BOUNDS_WAIT) | (1u << FACTOR_BOUNDS_NO_WAIT)
+      | (1u << FACTOR_READBACK);
+
+  printf("hardware threads: %u, competing threads: %d\n",
+      std::thread::hardware_concurrency(),
+      opts.numBackgroundThreads);
+
+  auto baselineTimes =
+      measureWithActivities(opts, library, device, scene, activities);
+  auto baseline = computeStats(baselineTimes);
+  const double baselineFPS = 1000.0 / baseline.mean;
+  const double runMS = std::max(
+      500.0, std::accumulate(baselineTimes.begin(), baselineTimes.end(), 0.0));
+
+  printf("%-10s %10s %10s %10s %10s %12s %10s %10s\n",
+      "workload", "fps", "mean[ms]", "p95[ms]", "slowdown",
+      "bg-rate", "bg-share", "fairness");
+  printf("%-10s %10.2f %10.3f %10.3f %10.2f %12s %10s %10s\n",
+      "none", baselineFPS, baseline.mean, baseline.p95, 1.0, "-", "-", "-");
+
+  for (const char *kind : {"cpu", "memory"}) {
+    CompetingWorkload workload(
+        kind, opts.numBackgroundThreads, opts.backgroundBufferMB << 20);
+
+    // Calibrate: the same workload without any rendering going on
+
+    workload.start();
+    std::this_thread::sleep_for(
+        std::chrono::duration<double, std::milli>(runMS));
+    auto aloneRates = workload.stop();
+
+    // Shared: render for at least as long as the calibration ran
+
+    workload.start();
+    auto stats = computeStats(measureWithActivities(
+        opts, library, device, scene, activities, {}, runMS));
+    auto sharedRates = workload.stop();
+
+    // Normalize every participant's progress to what it achieves alone
+
+    const double fps = 1000.0 / stats.mean;
+    std::vector<double> normalized = {fps / baselineFPS};
+    double sharedTotal = 0.0, aloneTotal = 0.0;
+    for (size_t i = 0; i < sharedRates.size(); i++) {
+      normalized.push_back(
+          aloneRates[i] > 0.0 ? sharedRates[i] / aloneRates[i] : 0.0);
+      sharedTotal += sharedRates[i];
+      aloneTotal += aloneRates[i];
+    }
+
+    const bool memory = workload.kind == "memory";
+    char rate[32];
+    snprintf(rate, sizeof(rate), memory ? "%.2fGB/s" : "%.1fMop/s",
+        memory ? sharedTotal / 1e9 : sharedTotal);
+
+    printf("%-10s %10.2f %10.3f %10.3f %10.2f %12s %10.2f %10.3f\n",
+        kind,
+        fps,
+        stats.mean,
+        stats.p95,
+        stats.mean / baseline.mean,
+        rate,
+        aloneTotal > 0.0 ? sharedTotal / aloneTotal : 0.0,
+        jainFairness(normalized));
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Priority experiments: raise the render thread, lower the
+//  query threads, and compare frame-time tails
+// ========================================================
+static void runPriorityExperiment(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const unsigned activities = (1u << FACTOR_EXTENSIONS)
+      | (1u << FACTOR_BOUNDS_WAIT) | (1u << FACTOR_BOUNDS_NO_WAIT)
+      | (1u << FACTOR_COMMITS);
+
+  struct Config
+  {
+    ThreadPriority render;
+    ThreadPriority query;
+  };
+  const ThreadPriority unchanged;
+  const Config configs[] = {
+      {unchanged, unchanged},
+      {opts.renderPriority, unchanged},
+      {unchanged, opts.queryPriority},
+      {opts.renderPriority, opts.queryPriority},
+  };
+
+  // Label what a thread actually ran at: a refused change leaves it at its
+  // inherited (default) priority
+  auto appliedLabel = [](const ThreadPriority &p, bool applied) {
+    return threadPriorityLabel(p) + (applied ? "" : " denied");
+  };
+
+  // The query threads apply their priority themselves; probe on a
+  // throwaway thread whether the OS permits it
+  auto permitted = [](const ThreadPriority &p) {
+    bool applied = false;
+    std::thread probe([&]() { applied = applyThreadPriority(p); });
+    probe.join();
+    return applied;
+  };
+
+  bool anyDenied = false;
+  printf("%-18s %-18s %10s %10s %10s %10s %10s\n",
+      "render", "query", "mean[ms]", "p50[ms]", "p95[ms]", "p99[ms]", "max[ms]");
+  for (const auto &config : configs) {
+    const bool queryApplied = permitted(config.query);
+
+    // Run the render loop on its own thread so the priority change does not
+    // leak into the main thread (and the next configuration)
+
+    bool applied = true;
+    std::vector<double> frameTimes;
+    std::thread renderThread([&]() {
+      setThreadRole("renderThread");
+      applied = applyThreadPriority(config.render);
+      frameTimes = measureWithActivities(
+          opts, library, device, scene, activities, config.query);
+    });
+    renderThread.join();
+
+    auto stats = computeStats(frameTimes);
+    printf("%-18s %-18s %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+        appliedLabel(config.render, applied).c_str(),
+        appliedLabel(config.query, queryApplied).c_str(),
+        stats.mean,
+        stats.p50,
+        stats.p95,
+        stats.p99,
+        stats.max);
+    anyDenied |= !applied || !queryApplied;
+  }
+  if (anyDenied) {
+    printf("denied: not permitted by the OS, measured at default priority "
+           "(see CAP_SYS_NICE, RLIMIT_RTPRIO/NICE)\n");
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Frame pacing: release frames on absolute deadlines and
+//  account for missed ones
+// ========================================================
+static void runPacedRendering(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  // Keep the usual query threads running; pacing is about what they do to
+  // an interactive loop
+
+  std::atomic<bool> finish{false};
+  std::thread queryExtensionThread([&]() {
+    setThreadRole("queryExtensionThread");
+    queryExtensionLoop(library, opts.deviceSubtype, finish);
+  });
+  std::thread queryBoundsWaitThread([&]() {
+    setThreadRole("queryBoundsWaitThread");
+    queryBoundsLoop(device, scene.world, ANARI_WAIT, finish);
+  });
+  std::thread queryBoundsNoWaitThread([&]() {
+    setThreadRole("queryBoundsNoWaitThread");
+    queryBoundsLoop(device, scene.world, ANARI_NO_WAIT, finish);
+  });
+
+  for (int i = 0; i < opts.numWarmupFrames; i++)
+    renderFrame(device, scene.frame);
+
+  const auto interval = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::milli>(opts.frameIntervalMS));
+
+  enum Cause
+  {
+    CAUSE_RENDER = 0,
+    CAUSE_READBACK,
+    CAUSE_WRITER,
+    NUM_CAUSES
+  };
+  const char *causeNames[NUM_CAUSES] = {"render", "readback", "writer"};
+  int missed[NUM_CAUSES] = {};
+  int droppedDeadlines = 0;
+
+  std::vector<double> lateness, presentIntervals, renderMS, readbackMS,
+      writerMS;
+  std::vector<unsigned char> pixels;
+
+  const auto start = Clock::now() + interval;
+  auto deadline = start;
+  Clock::time_point lastPresent{};
+  for (int i = 0; i < opts.numFrames; i++) {
+    std::this_thread::sleep_until(deadline);
+
+    const auto released = Clock::now();
+    renderFrame(device, scene.frame);
+    const auto rendered = Clock::now();
+
+    auto fb = anari::map<uint32_t>(device, scene.frame, "channel.color");
+    const int w = fb.width, h = fb.height;
+    pixels.assign((const unsigned char *)fb.data,
+        (const unsigned char *)(fb.data + size_t(w) * h));
+    anari::unmap(device, scene.frame, "channel.color");
+    const auto readback = Clock::now();
+
+    // Encode in memory to time the writer without measuring the disk
+    encodeImage(pixels.data(), w, h, opts.imageFormat);
+    const auto presented = Clock::now();
+
+    lateness.push_back(elapsedMS(deadline, released));
+    renderMS.push_back(elapsedMS(released, rendered));
+    readbackMS.push_back(elapsedMS(rendered, readback));
+    writerMS.push_back(elapsedMS(readback, presented));
+    if (i > 0)
+      presentIntervals.push_back(elapsedMS(lastPresent, presented));
+    lastPresent = presented;
+
+    // A frame misses its deadline if it is not presented before the next
+    // one is due; blame the stage during which the budget ran out
+
+    const auto due = deadline + interval;
+    if (presented > due) {
+      if (rendered > due)
+        missed[CAUSE_RENDER]++;
+      else if (readback > due)
+        missed[CAUSE_READBACK]++;
+      else
+        missed[CAUSE_WRITER]++;
+    }
+
+    // Like vsync: skip deadlines that have already passed
+
+    deadline = due;
+    while (deadline < presented) {
+      deadline += interval;
+      droppedDeadlines++;
+    }
+  }
+
+  finish = true;
+  queryExtensionThread.join();
+  queryBoundsWaitThread.join();
+  queryBoundsNoWaitThread.join();
+
+  const int totalMissed =
+      std::accumulate(std::begin(missed), std::end(missed), 0);
+  const double elapsed = elapsedMS(start, lastPresent);
+
+  printf("target interval: %.3fms (%.1f fps), %d frames in %.1fms, "
+         "writer encodes %s\n",
+      opts.frameIntervalMS,
+      1000.0 / opts.frameIntervalMS,
+      opts.numFrames,
+      elapsed,
+      imageFormatName(opts.imageFormat));
+  printf("missed deadlines: %d (%.1f%%), skipped deadlines: %d\n",
+      totalMissed,
+      100.0 * totalMissed / opts.numFrames,
+      droppedDeadlines);
+  for (int c = 0; c < NUM_CAUSES; c++)
+    printf("  caused by %-10s %d\n", causeNames[c], missed[c]);
+
+  auto printStats = [](const char *name, const std::vector<double> &samples) {
+    auto s = computeStats(samples);
+    printf("%-22s %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+        name, s.mean, s.stddev, s.p95, s.p99, s.max);
+  };
+  printf("%-22s %10s %10s %10s %10s %10s\n",
+      "[ms]", "mean", "stddev", "p95", "p99", "max");
+  printStats("release lateness", lateness);
+  printStats("present interval", presentIntervals);
+  printStats("render", renderMS);
+  printStats("readback", readbackMS);
+  printStats("writer", writerMS);
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Adaptive quality: closed-loop control of pixel samples
+//  and frame size to hold a frame-time budget
+// ========================================================
+static void runAdaptiveQuality(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const uint2 fullSize = {1024, 1024};
+  const int maxSamples = 16;
+  const float minScale = 0.25f;
+  const bool adaptSamples = opts.adaptKnob != "size";
+  const bool adaptSize = opts.adaptKnob != "samples";
+
+  // Load phases the controller has to follow: idle, queries, queries+commits
+
+  const unsigned phases[] = {0u,
+      (1u << FACTOR_EXTENSIONS) | (1u << FACTOR_BOUNDS_WAIT)
+          | (1u << FACTOR_BOUNDS_NO_WAIT),
+      (1u << FACTOR_EXTENSIONS) | (1u << FACTOR_BOUNDS_WAIT)
+          | (1u << FACTOR_BOUNDS_NO_WAIT) | (1u << FACTOR_COMMITS)};
+  const int numPhases = int(std::size(phases));
+  const int framesPerPhase = std::max(1, opts.numFrames / numPhases);
+
+  // The controlled quantity is the relative cost samples * scale^2; the
+  // integrating controller moves it by (budget / duration)^gain per frame.
+  // It stays continuous and is only rounded when applied; clamping it to
+  // the range the enabled knobs can reach keeps it from winding up
+
+  const float gain = 0.5f;
+  const float deadband = 0.1f;
+  const float minQuality = adaptSize ? minScale * minScale : 1.f;
+  const float maxQuality = adaptSamples ? float(maxSamples) : 1.f;
+  float quality = 1.f;
+  int samples = 1;
+  float scale = 1.f;
+
+  auto applyQuality = [&]() {
+    int newSamples = samples;
+    float newScale = scale;
+    if (adaptSamples && (!adaptSize || quality >= 1.f)) {
+      newSamples = std::clamp(int(std::lround(quality)), 1, maxSamples);
+      newScale = 1.f;
+    }
+    if (adaptSize && (!adaptSamples || quality < 1.f)) {
+      newScale = std::clamp(std::sqrt(quality), minScale, 1.f);
+      newSamples = 1;
+    }
+
+    if (newSamples != samples) {
+      samples = newSamples;
+      anari::setParameter(device, scene.renderer, "pixelSamples", samples);
+      anari::commitParameters(device, scene.renderer);
+    }
+    if (newScale != scale) {
+      scale = newScale;
+      uint2 size = {uint32_t(fullSize[0] * scale), uint32_t(fullSize[1] * scale)};
+      anari::setParameter(device, scene.frame, "size", size);
+      anari::commitParameters(device, scene.frame);
+    }
+  };
+
+  printf("budget: %.3fms, adapting: %s\n",
+      opts.budgetMS, opts.adaptKnob.c_str());
+  printf("%6s %6s %12s %8s %6s %10s\n",
+      "frame", "phase", "duration[ms]", "samples", "scale", "size");
+
+  std::vector<double> error;
+  int withinBudget = 0;
+  ConcurrentActivities activities;
+  for (int phase = 0, frame = 0; phase < numPhases; phase++) {
+    activities.start(opts, library, device, scene, phases[phase]);
+    for (int i = 0; i < framesPerPhase; i++, frame++) {
+      const double durationMS = renderFrame(device, scene.frame) * 1000.0;
+      printf("%6d %6d %12.3f %8d %6.3f %5ux%-5u\n",
+          frame,
+          phase,
+          durationMS,
+          samples,
+          scale,
+          uint32_t(fullSize[0] * scale),
+          uint32_t(fullSize[1] * scale));
+
+      error.push_back(durationMS - opts.budgetMS);
+      if (durationMS <= opts.budgetMS)
+        withinBudget++;
+
+      if (durationMS <= 0.0)
+        continue;
+      const double ratio = opts.budgetMS / durationMS;
+      if (std::abs(ratio - 1.0) > deadband) {
+        quality = std::clamp(quality * float(std::pow(ratio, gain)),
+            minQuality,
+            maxQuality);
+        applyQuality();
+      }
+    }
+    activities.stop();
+  }
+
+  double sumSq = 0.0;
+  for (double e : error)
+    sumSq += e * e;
+  printf("within budget: %d/%zu frames, rms error: %.3fms\n",
+      withinBudget,
+      error.size(),
+      std::sqrt(sumSq / std::max<size_t>(error.size(), 1)));
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Tile-parallel rendering: K frames, each covering a strip
+//  of the image via the camera's image region
+// ========================================================
+struct Tile
+{
+  anari::Camera camera{nullptr};
+  anari::Frame frame{nullptr};
+  uint32_t rowBegin{0};
+  uint32_t rowEnd{0};
+};
+
+static std::vector<Tile> createTiles(anari::Device device,
+    const Scene &scene,
+    const uint2 &imageSize,
+    int numTiles)
+{
+  std::vector<Tile> tiles(numTiles);
+  for (int k = 0; k < numTiles; k++) {
+    auto &tile = tiles[k];
+    tile.rowBegin = uint32_t(uint64_t(imageSize[1]) * k / numTiles);
+    tile.rowEnd = uint32_t(uint64_t(imageSize[1]) * (k + 1) / numTiles);
+
+    // Image region is in normalized screen space with the origin in the
+    // lower left, matching the row order of the mapped color channel
+
+    const box2 region = {
+        float2(0.f, float(tile.rowBegin) / imageSize[1]),
+        float2(1.f, float(tile.rowEnd) / imageSize[1])};
+    tile.camera = tracked(device,
+        anari::newObject<anari::Camera>(device, "perspective"),
+        __func__);
+    anari::setParameter(device, tile.camera, "imageRegion", region);
+    anari::setParameter(
+        device, tile.camera, "aspect", float(imageSize[0]) / imageSize[1]);
+    initializeCamera(device, tile.camera);
+
+    tile.frame =
+        tracked(device, anari::newObject<anari::Frame>(device), __func__);
+    initializeFrame(
+        device, tile.frame, scene.world, scene.renderer, tile.camera);
+    const uint2 tileSize = {imageSize[0], tile.rowEnd - tile.rowBegin};
+    anari::setParameter(device, tile.frame, "size", tileSize);
+    anari::commitParameters(device, tile.frame);
+  }
+  return tiles;
+}
+
+static void releaseTiles(anari::Device device, std::vector<Tile> &tiles)
+{
+  for (auto &tile : tiles) {
+    anari::release(device, tile.camera);
+    anari::release(device, tile.frame);
+  }
+  tiles.clear();
+}
+
+static void copyTile(anari::Device device,
+    const Tile &tile,
+    uint32_t imageWidth,
+    std::vector<uint32_t> &image)
+{
+  auto fb = anari::map<uint32_t>(device, tile.frame, "channel.color");
+  std::copy(fb.data,
+      fb.data + size_t(fb.width) * fb.height,
+      image.begin() + size_t(tile.rowBegin) * imageWidth);
+  anari::unmap(device, tile.frame, "channel.color");
+}
+
+static void runTiledRendering(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const uint2 imageSize = {1024, 1024};
+  const int numTiles = std::clamp(opts.numTiles, 1, int(imageSize[1]));
+  auto tiles = createTiles(device, scene, imageSize, numTiles);
+
+  std::vector<uint32_t> image(size_t(imageSize[0]) * imageSize[1]);
+
+  // Single frame: render + readback //
+
+  auto renderSingle = [&]() {
+    renderFrame(device, scene.frame);
+    auto fb = anari::map<uint32_t>(device, scene.frame, "channel.color");
+    std::copy(fb.data, fb.data + image.size(), image.begin());
+    anari::unmap(device, scene.frame, "channel.color");
+  };
+
+  // Tiles, one application thread per tile //
+
+  auto renderTilesThreaded = [&]() {
+    std::vector<std::thread> threads;
+    for (const auto &tile : tiles) {
+      threads.emplace_back([&]() {
+        setThreadRole("tileThread");
+        renderFrame(device, tile.frame);
+        copyTile(device, tile, imageSize[0], image);
+      });
+    }
+    for (auto &t : threads)
+      t.join();
+  };
+
+  // Tiles, all renders issued from one thread, then waited on //
+
+  auto renderTilesAsync = [&]() {
+    for (const auto &tile : tiles)
+      anari::render(device, tile.frame);
+    for (const auto &tile : tiles) {
+      anari::wait(device, tile.frame);
+      copyTile(device, tile, imageSize[0], image);
+    }
+  };
+
+  auto measure = [&](auto &&renderImage) {
+    return computeStats(
+        measureRepeated(opts.numWarmupFrames, opts.numFrames, renderImage));
+  };
+
+  const auto single = measure(renderSingle);
+  const auto threaded = measure(renderTilesThreaded);
+  const auto async = measure(renderTilesAsync);
+
+  writeImage(
+      std::string("out_tiled.") + imageFormatExtension(opts.imageFormat),
+      (const unsigned char *)image.data(),
+      imageSize[0],
+      imageSize[1],
+      opts.imageFormat);
+
+  printf("%d tiles of %ux~%u pixels\n",
+      numTiles, imageSize[0], imageSize[1] / numTiles);
+  printf("%-22s %10s %10s %10s %10s\n",
+      "path", "mean[ms]", "p95[ms]", "fps", "speedup");
+  auto print = [&](const char *name, const TimingStats &s) {
+    printf("%-22s %10.3f %10.3f %10.2f %10.2f\n",
+        name, s.mean, s.p95, 1000.0 / s.mean, single.mean / s.mean);
+  };
+  print("single frame", single);
+  print("tiles (threads)", threaded);
+  print("tiles (async issue)", async);
+
+  releaseTiles(device, tiles);
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Double-buffered world swap: build the next world in the
+//  background, then switch the frame over to it
+// ========================================================
+static void runWorldSwap(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const int numSwaps = opts.numSwaps;
+  std::atomic<anari::World> pending{nullptr};
+  std::atomic<anari::World> retired{nullptr};
+  std::vector<double> buildMS;
+
+  std::thread builderThread([&]() {
+    setThreadRole("builderThread");
+    for (int s = 1; s <= numSwaps; s++) {
+      auto begin = Clock::now();
+      SphereSet set;
+      set.seed = s;
+      auto world =
+          tracked(device, anari::newObject<anari::World>(device), __func__);
+      initializeWorld(device, world, sceneCenter, set);
+      buildMS.push_back(elapsedMS(begin, Clock::now()));
+
+      pending = world;
+      while (pending.load() != nullptr)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+      // Release the old world here so its teardown can't stall a frame
+      anari::release(device, retired.exchange(nullptr));
+    }
+  });
+
+  // No swaps during warmup; after it, each swap follows at least
+  // steadyFrames steady frames (more if the next world isn't built yet),
+  // so every hitch is measured from a settled frame.
+  // Per swap: the swap itself plus the first frame rendered after it
+  const int steadyFrames = 3;
+  std::vector<double> steadyMS, hitchMS, swapMS, swapAndHitchMS;
+  int swapsDone = 0, sinceSwap = 0;
+  for (int i = 0;
+       swapsDone < numSwaps || i < opts.numWarmupFrames + opts.numFrames;
+       i++) {
+    const bool warmup = i < opts.numWarmupFrames;
+    bool swapped = false;
+    if (!warmup && swapsDone < numSwaps && sinceSwap >= steadyFrames) {
+      if (anari::World world = pending.load()) {
+        auto begin = Clock::now();
+        anari::setParameter(device, scene.frame, "world", world);
+        anari::commitParameters(device, scene.frame);
+        swapMS.push_back(elapsedMS(begin, Clock::now()));
+
+        retired = scene.world;
+        scene.world = world;
+        pending = nullptr;
+        swapped = true;
+        swapsDone++;
+        sinceSwap = 0;
+      }
+    }
+
+    auto begin = Clock::now();
+    renderFrame(device, scene.frame);
+    const double ms = elapsedMS(begin, Clock::now());
+
+    if (warmup)
+      continue;
+    if (swapped) {
+      hitchMS.push_back(ms);
+      swapAndHitchMS.push_back(swapMS.back() + ms);
+    } else {
+      steadyMS.push_back(ms);
+      sinceSwap++;
+    }
+  }
+
+  builderThread.join();
+
+  const auto steady = computeStats(steadyMS);
+  const auto hitch = computeStats(hitchMS);
+  const auto swap = computeStats(swapMS);
+  const auto build = computeStats(buildMS);
+  const auto swapAndHitch = computeStats(swapAndHitchMS);
+  printf("%d swaps over %zu frames\n",
+      numSwaps, steadyMS.size() + hitchMS.size());
+  printf("%-28s %10s %10s %10s\n", "[ms]", "mean", "p95", "max");
+  printf("%-28s %10.3f %10.3f %10.3f\n",
+      "background world build", build.mean, build.p95, build.max);
+  printf("%-28s %10.3f %10.3f %10.3f\n",
+      "swap (set world + commit)", swap.mean, swap.p95, swap.max);
+  printf("%-28s %10.3f %10.3f %10.3f\n",
+      "frame, steady", steady.mean, steady.p95, steady.max);
+  printf("%-28s %10.3f %10.3f %10.3f\n",
+      "frame, first after swap", hitch.mean, hitch.p95, hitch.max);
+  if (steadyMS.empty() || swapAndHitchMS.empty())
+    printf("hitch: n/a (no steady frames or no swaps)\n");
+  else {
+    printf("hitch: %+.3fms mean, %+.3fms worst vs steady mean\n",
+        swapAndHitch.mean - steady.mean,
+        swapAndHitch.max - steady.mean);
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Time-varying playback: procedurally evolved timesteps,
+//  either preloaded as device arrays or streamed per step
+// ========================================================
+
+// Resident set size of this process in bytes (0 where unsupported)
+static size_t residentBytes()
+{
+  size_t pages = 0;
+#ifdef __linux__
+  if (FILE *fp = fopen("/proc/self/statm", "r")) {
+    size_t total = 0;
+    if (fscanf(fp, "%zu %zu", &total, &pages) != 2)
+      pages = 0;
+    fclose(fp);
+  }
+  return pages * size_t(sysconf(_SC_PAGESIZE));
+#else
+  return pages;
+#endif
+}
+
+// One timestep of differential rotation around the vertical axis through
+// center: inner spheres orbit faster, like a (very) simplified galaxy
+static void evolveSpheres(float3 *positions, size_t n, const float3 &center)
+{
+  for (size_t i = 0; i < n; i++) {
+    const float x = positions[i][0] - center[0];
+    const float z = positions[i][2] - center[2];
+    const float angle = 0.02f / (0.2f + std::sqrt(x * x + z * z));
+    const float c = std::cos(angle), s = std::sin(angle);
+    positions[i][0] = center[0] + c * x - s * z;
+    positions[i][2] = center[2] + s * x + c * z;
+  }
+}
+
+static void runPlayback(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  SphereSet set;
+  set.numSpheres = opts.numSpheres;
+  const int numTimesteps = opts.numTimesteps;
+  const size_t stepBytes = size_t(set.numSpheres) * sizeof(float3);
+
+  // Timestep 0 is exactly the regular scene
+  std::vector<float3> initialPositions(set.numSpheres);
+  generateSpheres(set, sceneCenter, initialPositions.data(), nullptr, nullptr);
+
+  printf("%u spheres, %d timesteps, %.1f MB per timestep\n",
+      set.numSpheres, numTimesteps, stepBytes / 1e6);
+  printf("%-12s %10s %12s %12s %12s %10s %10s %11s\n",
+      "strategy", "setup[ms]", "update[ms]", "render[ms]", "steps/s",
+      "p95[ms]", "rss[MB]", "arrays[MB]");
+
+  for (const char *strategy : {"preload", "stream-map", "stream-new"}) {
+    const std::string name = strategy;
+
+    // Memory is the growth of the resident set from here to the end of
+    // playback: arrays, the device's copies and the simulation state. As
+    // the allocator keeps pages freed by the previous strategy, it is
+    // reported next to the peak size of the position arrays alive at once,
+    // which does not depend on the order
+    const size_t memoryBefore = residentBytes();
+    size_t arrayBytes = stepBytes; // the geometry's initial positions
+    size_t peakArrayBytes = arrayBytes;
+    auto arrayCreated = [&]() {
+      arrayBytes += stepBytes;
+      peakArrayBytes = std::max(peakArrayBytes, arrayBytes);
+    };
+    bool initialHeld = true;
+
+    auto geometry = newSphereGeometry(device, set, sceneCenter);
+    auto world =
+        tracked(device, anari::newObject<anari::World>(device), __func__);
+    initializeWorld(device, world, geometry);
+    Scene scene = createScene(device, world);
+
+    // Setup: preload generates and uploads every timestep up front //
+
+    auto setupBegin = Clock::now();
+    std::vector<float3> positions = initialPositions;
+    std::vector<anari::Array1D> timesteps;
+    anari::Array1D streamArray = nullptr;
+    if (name == "preload") {
+      for (int t = 0; t < numTimesteps; t++) {
+        auto array = tracked(device,
+            anari::newArray1D(device, ANARI_FLOAT32_VEC3, set.numSpheres),
+            __func__);
+        arrayCreated();
+        auto *p = anari::map<float3>(device, array);
+        std::copy(positions.begin(), positions.end(), p);
+        anari::unmap(device, array);
+        timesteps.push_back(array);
+        evolveSpheres(positions.data(), positions.size(), sceneCenter);
+      }
+    } else if (name == "stream-map") {
+      streamArray = tracked(device,
+          anari::newArray1D(device, ANARI_FLOAT32_VEC3, set.numSpheres),
+          __func__);
+      arrayCreated();
+    }
+    const double setupMS = elapsedMS(setupBegin, Clock::now());
+
+    // Playback: warmup replays timestep 0 for every strategy //
+
+    std::vector<double> updateMS, renderMS, stepMS;
+    for (int i = 0; i < opts.numWarmupFrames + numTimesteps; i++) {
+      const int t = std::max(0, i - opts.numWarmupFrames) % numTimesteps;
+
+      auto begin = Clock::now();
+      if (name == "preload") {
+        anari::setParameter(
+            device, geometry, "vertex.position", timesteps[t]);
+      } else {
+        anari::Array1D array = streamArray;
+        if (!array) {
+          array = tracked(device,
+              anari::newArray1D(device, ANARI_FLOAT32_VEC3, set.numSpheres),
+              __func__);
+          arrayCreated();
+        }
+        auto *p = anari::map<float3>(device, array);
+        std::copy(positions.begin(), positions.end(), p);
+        anari::unmap(device, array);
+        if (streamArray)
+          anari::setParameter(device, geometry, "vertex.position", array);
+        else
+          anari::setAndReleaseParameter(
+              device, geometry, "vertex.position", array);
+        if (i >= opts.numWarmupFrames)
+          evolveSpheres(positions.data(), positions.size(), sceneCenter);
+      }
+      // The replaced array goes away unless the strategy still holds it
+      if (initialHeld || name == "stream-new")
+        arrayBytes -= stepBytes;
+      initialHeld = false;
+      anari::commitParameters(device, geometry);
+      auto updated = Clock::now();
+      renderFrame(device, scene.frame);
+      auto end = Clock::now();
+
+      if (i >= opts.numWarmupFrames) {
+        updateMS.push_back(elapsedMS(begin, updated));
+        renderMS.push_back(elapsedMS(updated, end));
+        stepMS.push_back(elapsedMS(begin, end));
+      }
+    }
+    const size_t memoryAfter = residentBytes();
+
+    const auto update = computeStats(updateMS);
+    const auto render = computeStats(renderMS);
+    const auto step = computeStats(stepMS);
+    printf("%-12s %10.3f %12.3f %12.3f %12.2f %10.3f %10.1f %11.1f\n",
+        strategy,
+        setupMS,
+        update.mean,
+        render.mean,
+        1000.0 / step.mean,
+        step.p95,
+        (double(memoryAfter) - double(memoryBefore)) / 1e6,
+        peakArrayBytes / 1e6);
+
+    for (auto array : timesteps)
+      anari::release(device, array);
+    if (streamArray)
+      anari::release(device, streamArray);
+    anari::release(device, geometry);
+    releaseScene(device, scene);
+  }
+}
+
+// ========================================================
+// Level of detail: progressively subsampled sphere sets
+//  with radius compensation, switched during navigation
+// ========================================================
+static void orbitCamera(
+    anari::Device device, anari::Camera camera, float angle)
+{
+  // Orbit the default view around the data set's center
+  const float3 offset = sceneEye - sceneCenter;
+  const float c = std::cos(angle), s = std::sin(angle);
+  const float3 rotated(
+      c * offset[0] + s * offset[2], offset[1], -s * offset[0] + c * offset[2]);
+  const float3 direction(-rotated[0], 0.f, -rotated[2]);
+  anari::setParameter(device, camera, "position", sceneCenter + rotated);
+  anari::setParameter(device, camera, "direction", normalize(direction));
+  anari::setParameter(device, camera, "up", float3(0, 1, 0));
+  anari::commitParameters(device, camera);
+}
+
+static std::vector<unsigned char> readColor(
+    anari::Device device, anari::Frame frame)
+{
+  auto fb = anari::map<uint32_t>(device, frame, "channel.color");
+  const auto *bytes = (const unsigned char *)fb.data;
+  std::vector<unsigned char> pixels(
+      bytes, bytes + size_t(fb.width) * fb.height * 4);
+  anari::unmap(device, frame, "channel.color");
+  return pixels;
+}
+
+// Mean absolute difference of the RGB channels, in 8-bit units
+static double imageError(
+    const std::vector<unsigned char> &a, const std::vector<unsigned char> &b)
+{
+  const size_t n = std::min(a.size(), b.size());
+  uint64_t sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (i % 4 != 3)
+      sum += std::abs(int(a[i]) - int(b[i]));
+  }
+  return n ? double(sum) / (n / 4 * 3) : 0.0;
+}
+
+static void runLevelOfDetail(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  SphereSet set;
+  set.numSpheres = opts.numSpheres;
+
+  // The generated spheres are i.i.d., so every prefix is a uniform random
+  // subsample and coarser levels are simply shorter prefixes
+
+  std::vector<float3> positions(set.numSpheres);
+  std::vector<float> distances(set.numSpheres);
+  generateSpheres(
+      set, sceneCenter, positions.data(), distances.data(), nullptr);
+
+  struct Level
+  {
+    uint32_t numSpheres;
+    float radius;
+    anari::World world;
+    double renderMS;
+    double error;
+  };
+  std::vector<Level> levels;
+  for (uint32_t n = set.numSpheres; levels.size() < size_t(opts.numLODLevels);
+       n = std::max(1u, n / 4)) {
+    // Keep the total projected area: radius grows with sqrt(N0 / N)
+    const float radius = set.radius * std::sqrt(float(set.numSpheres) / n);
+    auto geometry = newSphereGeometry(
+        device, positions.data(), distances.data(), n, radius);
+    auto world =
+        tracked(device, anari::newObject<anari::World>(device), __func__);
+    initializeWorld(device, world, geometry);
+    anari::release(device, geometry);
+    levels.push_back({n, radius, world, 0.0, 0.0});
+    if (n == 1)
+      break;
+  }
+
+  Scene scene = createScene(device, levels[0].world);
+
+  auto useLevel = [&](size_t l) {
+    anari::setParameter(device, scene.frame, "world", levels[l].world);
+    anari::commitParameters(device, scene.frame);
+  };
+
+  // Quality/time trade-off of every level //
+
+  std::vector<unsigned char> reference;
+  printf("%6s %12s %10s %12s %12s\n",
+      "level", "spheres", "radius", "render[ms]", "error[1/255]");
+  for (size_t l = 0; l < levels.size(); l++) {
+    useLevel(l);
+    const auto frameTimes =
+        measureRepeated(opts.numWarmupFrames, opts.numFrames, [&]() {
+          renderFrame(device, scene.frame);
+        });
+    auto pixels = readColor(device, scene.frame);
+    if (l == 0)
+      reference = pixels;
+
+    levels[l].renderMS = computeStats(frameTimes).mean;
+    levels[l].error = imageError(reference, pixels);
+    printf("%6zu %12u %10.4f %12.3f %12.3f\n",
+        l, levels[l].numSpheres, levels[l].radius, levels[l].renderMS,
+        levels[l].error);
+  }
+
+  // Navigation: orbit (moving) then hold still, alternating. While moving
+  // use the finest level that fits the budget, refine once the camera stops
+
+  size_t movingLevel = levels.size() - 1;
+  for (size_t l = 0; l < levels.size(); l++) {
+    if (levels[l].renderMS <= opts.budgetMS) {
+      movingLevel = l;
+      break;
+    }
+  }
+
+  std::vector<double> movingMS, stillMS;
+  size_t current = size_t(-1);
+  float angle = 0.f;
+  const int phaseLength = std::max(1, opts.numFrames);
+  for (int i = 0; i < 4 * phaseLength; i++) {
+    const bool moving = (i / phaseLength) % 2 == 0;
+    const size_t level = moving ? movingLevel : 0;
+
+    auto begin = Clock::now();
+    if (moving) {
+      angle += 0.05f;
+      orbitCamera(device, scene.camera, angle);
+    }
+    if (level != current) {
+      useLevel(level);
+      current = level;
+    }
+    renderFrame(device, scene.frame);
+    (moving ? movingMS : stillMS).push_back(elapsedMS(begin, Clock::now()));
+  }
+
+  const auto moving = computeStats(movingMS);
+  const auto still = computeStats(stillMS);
+  printf("navigation with %.3fms budget: level %zu while moving, 0 when still\n",
+      opts.budgetMS, movingLevel);
+  printf("%-10s %10s %10s %10s %12s\n",
+      "[ms]", "mean", "p95", "max", "in budget");
+  auto print = [&](const char *name, const std::vector<double> &samples,
+                   const TimingStats &s) {
+    const auto inBudget = std::count_if(samples.begin(),
+        samples.end(), [&](double ms) { return ms <= opts.budgetMS; });
+    printf("%-10s %10.3f %10.3f %10.3f %11.1f%%\n",
+        name, s.mean, s.p95, s.max, 100.0 * inBudget / samples.size());
+  };
+  print("moving", movingMS, moving);
+  print("still", stillMS, still);
+
+  // The level worlds are released below, not through the scene
+  scene.world = nullptr;
+  releaseScene(device, scene);
+  for (auto &level : levels)
+    anari::release(device, level.world);
+}
+
+// ========================================================
+// Object-count scaling: the same spheres split across
+//  1, 10, ... surfaces, each with its own geometry
+// ========================================================
+
+// One geometry + surface per contiguous chunk of the n spheres
+static std::vector<anari::Surface> newSphereSurfaces(anari::Device device,
+    const float3 *positions,
+    const float *distances,
+    uint32_t n,
+    uint32_t numSurfaces,
+    float radius,
+    anari::Material material)
+{
+  std::vector<anari::Surface> surfaces(numSurfaces);
+  for (uint32_t s = 0; s < numSurfaces; s++) {
+    const uint32_t first = uint64_t(n) * s / numSurfaces;
+    const uint32_t last = uint64_t(n) * (s + 1) / numSurfaces;
+    auto geometry = newSphereGeometry(
+        device, positions + first, distances + first, last - first, radius);
+    surfaces[s] = tracked(
+        device, anari::newObject<anari::Surface>(device), __func__);
+    anari::setAndReleaseParameter(device, surfaces[s], "geometry", geometry);
+    anari::setParameter(device, surfaces[s], "material", material);
+    anari::commitParameters(device, surfaces[s]);
+  }
+  return surfaces;
+}
+
+static void runObjectCountScaling(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  SphereSet set;
+  set.numSpheres = opts.numSpheres;
+  std::vector<float3> positions(set.numSpheres);
+  std::vector<float> distances(set.numSpheres);
+  generateSpheres(set,
+      sceneCenter, positions.data(), distances.data(), nullptr);
+
+  auto renderer = tracked(device,
+      anari::newObject<anari::Renderer>(device, "default"),
+      __func__);
+  initializeRenderer(device, renderer);
+  auto camera = tracked(device,
+      anari::newObject<anari::Camera>(device, "perspective"),
+      __func__);
+  initializeCamera(device, camera);
+  auto material = newColorMapMaterial(device);
+
+  printf("%u spheres\n", set.numSpheres);
+  printf("%10s %12s %12s %12s %12s %12s %12s\n",
+      "surfaces", "create[ms]", "commit[ms]", "bounds[ms]", "first[ms]",
+      "render[ms]", "memory[MB]");
+
+  for (uint32_t numSurfaces = 1; numSurfaces <= set.numSpheres;
+       numSurfaces *= 10) {
+    const size_t memoryBefore = residentBytes();
+
+    auto begin = Clock::now();
+    auto surfaces = newSphereSurfaces(device,
+        positions.data(),
+        distances.data(),
+        set.numSpheres,
+        numSurfaces,
+        set.radius,
+        material);
+
+    auto surfaceArray = tracked(device,
+        anari::newArray1D(device, ANARI_SURFACE, numSurfaces),
+        __func__);
+    std::copy(surfaces.begin(),
+        surfaces.end(),
+        anari::map<anari::Surface>(device, surfaceArray));
+    anari::unmap(device, surfaceArray);
+    for (auto surface : surfaces)
+      anari::release(device, surface);
+
+    auto world =
+        tracked(device, anari::newObject<anari::World>(device), __func__);
+    anari::setAndReleaseParameter(device, world, "surface", surfaceArray);
+    auto light = tracked(device,
+        anari::newObject<anari::Light>(device, "directional"),
+        __func__);
+    anari::setParameterArray1D(device, world, "light", &light, 1);
+    anari::release(device, light);
+    auto created = Clock::now();
+
+    anari::commitParameters(device, world);
+    auto committed = Clock::now();
+
+    // Most devices build their acceleration structure lazily; a waiting
+    // bounds query forces the world to be up to date
+    float bounds[6];
+    anariGetProperty(device, world, "bounds", ANARI_FLOAT32_BOX3,
+        bounds, sizeof(bounds), ANARI_WAIT);
+    auto updated = Clock::now();
+
+    auto frame =
+        tracked(device, anari::newObject<anari::Frame>(device), __func__);
+    initializeFrame(device, frame, world, renderer, camera);
+    auto firstBegin = Clock::now();
+    renderFrame(device, frame);
+    const double firstMS = elapsedMS(firstBegin, Clock::now());
+
+    std::vector<double> frameTimes;
+    for (int i = 0; i < opts.numFrames; i++) {
+      auto frameBegin = Clock::now();
+      renderFrame(device, frame);
+      frameTimes.push_back(elapsedMS(frameBegin, Clock::now()));
+    }
+    const size_t memoryAfter = residentBytes();
+
+    printf("%10u %12.3f %12.3f %12.3f %12.3f %12.3f %12.1f\n",
+        numSurfaces,
+        elapsedMS(begin, created),
+        elapsedMS(created, committed),
+        elapsedMS(committed, updated),
+        firstMS,
+        computeStats(frameTimes).mean,
+        (double(memoryAfter) - double(memoryBefore)) / 1e6);
+
+    anari::release(device, frame);
+    anari::release(device, world);
+  }
+
+  anari::release(device, material);
+  anari::release(device, camera);
+  anari::release(device, renderer);
+}
+
+// ========================================================
+// Object array construction paths: rebuild the world's
+//  surface list every frame through each path
+// ========================================================
+static void runObjectArrayPaths(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  SphereSet set;
+  set.numSpheres = opts.numSpheres;
+  std::vector<float3> positions(set.numSpheres);
+  std::vector<float> distances(set.numSpheres);
+  generateSpheres(set,
+      sceneCenter, positions.data(), distances.data(), nullptr);
+
+  Scene scene = createScene(device);
+  auto material = newColorMapMaterial(device);
+
+  // Keep the usual query threads running against the world being rebuilt
+  const unsigned activities = (1u << FACTOR_EXTENSIONS)
+      | (1u << FACTOR_BOUNDS_WAIT) | (1u << FACTOR_BOUNDS_NO_WAIT);
+
+  printf("%10s %8s %14s %14s %12s %12s\n",
+      "objects", "path", "array[us]", "commit[us]", "p95[us]", "frame[ms]");
+
+  for (uint32_t numSurfaces : {1u, 16u, 256u, 4096u}) {
+    numSurfaces = std::min(numSurfaces, set.numSpheres);
+
+    auto surfaces = newSphereSurfaces(device,
+        positions.data(),
+        distances.data(),
+        set.numSpheres,
+        numSurfaces,
+        set.radius,
+        material);
+
+    for (auto path : {ObjectArrayPath::NEW_AND_MAP,
+             ObjectArrayPath::APP_MEMORY,
+             ObjectArrayPath::SET_PARAMETER}) {
+      ConcurrentActivities concurrent;
+      concurrent.start(opts, library, device, scene, activities);
+
+      std::vector<double> arrayUS, commitUS, frameMS;
+      for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+        auto begin = Clock::now();
+        setObjectArray(device,
+            scene.world,
+            "surface",
+            ANARI_SURFACE,
+            surfaces.data(),
+            numSurfaces,
+            path);
+        auto arraySet = Clock::now();
+        anari::commitParameters(device, scene.world);
+        auto committed = Clock::now();
+        renderFrame(device, scene.frame);
+        auto end = Clock::now();
+
+        if (i >= opts.numWarmupFrames) {
+          arrayUS.push_back(elapsedMS(begin, arraySet) * 1000.0);
+          commitUS.push_back(elapsedMS(arraySet, committed) * 1000.0);
+          frameMS.push_back(elapsedMS(begin, end));
+        }
+      }
+
+      concurrent.stop();
+
+      const auto array = computeStats(arrayUS);
+      printf("%10u %8s %14.2f %14.2f %12.2f %12.3f\n",
+          numSurfaces,
+          objectArrayPathName(path),
+          array.mean,
+          computeStats(commitUS).mean,
+          array.p95,
+          computeStats(frameMS).mean);
+    }
+
+    // The world keeps its own references to the surfaces
+    for (auto surface : surfaces)
+      anari::release(device, surface);
+  }
+
+  anari::release(device, material);
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Quantized sphere storage: per-cluster 16-bit positions
+//  and 8-bit attributes, decoded straight into mapped arrays
+// ========================================================
+struct QuantizedSpheres
+{
+  struct Cluster
+  {
+    float3 origin;
+    float3 scale; // extent / 65535 per axis
+    float attributeMin;
+    float attributeScale; // range / 255
+    uint32_t first;
+    uint32_t count;
+  };
+
+  static constexpr uint32_t clusterSize = 1024;
+
+  std::vector<Cluster> clusters;
+  std::vector<uint16_t> x, y, z; // SoA, so 4 spheres decode per SIMD op
+  std::vector<uint8_t> attribute;
+  // Input sphere of every stored one; a scene cache would keep the spheres
+  // in this order, so it is only used for validation and not counted
+  std::vector<uint32_t> order;
+
+  size_t bytes() const
+  {
+    return clusters.size() * sizeof(Cluster)
+        + (x.size() + y.size() + z.size()) * sizeof(uint16_t)
+        + attribute.size();
+  }
+};
+
+// Spreads the low 10 bits of v to every third bit
+static uint32_t expandBits10(uint32_t v)
+{
+  v &= 0x3ff;
+  v = (v * 0x00010001u) & 0xff0000ffu;
+  v = (v * 0x00000101u) & 0x0f00f00fu;
+  v = (v * 0x00000011u) & 0xc30c30c3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+static QuantizedSpheres quantizeSpheres(
+    const float3 *input, const float *inputAttributes, uint32_t numSpheres)
+{
+  QuantizedSpheres q;
+  q.x.resize(numSpheres);
+  q.y.resize(numSpheres);
+  q.z.resize(numSpheres);
+  q.attribute.resize(numSpheres);
+
+  // Sort the spheres along a Morton curve over their bounding box, so that
+  // consecutive spheres, and therefore clusters, are spatially compact:
+  // only then do per-cluster origin/scale beat one global quantization
+
+  float3 boxLo = input[0], boxHi = input[0];
+  for (uint32_t i = 0; i < numSpheres; i++) {
+    boxLo = min(boxLo, input[i]);
+    boxHi = max(boxHi, input[i]);
+  }
+  std::vector<uint32_t> codes(numSpheres);
+  for (uint32_t i = 0; i < numSpheres; i++) {
+    uint32_t cell[3];
+    for (int d = 0; d < 3; d++) {
+      const float t =
+          (input[i][d] - boxLo[d]) / std::max(boxHi[d] - boxLo[d], 1e-20f);
+      cell[d] = uint32_t(std::clamp(t * 1024.f, 0.f, 1023.f));
+    }
+    codes[i] = (expandBits10(cell[0]) << 2) | (expandBits10(cell[1]) << 1)
+        | expandBits10(cell[2]);
+  }
+  q.order.resize(numSpheres);
+  std::iota(q.order.begin(), q.order.end(), 0u);
+  std::sort(q.order.begin(), q.order.end(), [&](uint32_t a, uint32_t b) {
+    return codes[a] < codes[b];
+  });
+
+  std::vector<float3> positions(numSpheres);
+  std::vector<float> attributes(numSpheres);
+  for (uint32_t i = 0; i < numSpheres; i++) {
+    positions[i] = input[q.order[i]];
+    attributes[i] = inputAttributes[q.order[i]];
+  }
+
+  for (uint32_t first = 0; first < numSpheres;
+       first += QuantizedSpheres::clusterSize) {
+    const uint32_t count =
+        std::min(QuantizedSpheres::clusterSize, numSpheres - first);
+
+    float3 lo = positions[first], hi = positions[first];
+    float attrLo = attributes[first], attrHi = attributes[first];
+    for (uint32_t i = first; i < first + count; i++) {
+      lo = min(lo, positions[i]);
+      hi = max(hi, positions[i]);
+      attrLo = std::min(attrLo, attributes[i]);
+      attrHi = std::max(attrHi, attributes[i]);
+    }
+
+    QuantizedSpheres::Cluster c;
+    c.origin = lo;
+    for (int d = 0; d < 3; d++)
+      c.scale[d] = std::max(hi[d] - lo[d], 1e-20f) / 65535.f;
+    c.attributeMin = attrLo;
+    c.attributeScale = std::max(attrHi - attrLo, 1e-20f) / 255.f;
+    c.first = first;
+    c.count = count;
+    q.clusters.push_back(c);
+
+    auto quantize = [](float v, float lo, float scale, float maxValue) {
+      return std::clamp(std::nearbyint((v - lo) / scale), 0.f, maxValue);
+    };
+    for (uint32_t i = first; i < first + count; i++) {
+      q.x[i] = uint16_t(quantize(positions[i][0], lo[0], c.scale[0], 65535.f));
+      q.y[i] = uint16_t(quantize(positions[i][1], lo[1], c.scale[1], 65535.f));
+      q.z[i] = uint16_t(quantize(positions[i][2], lo[2], c.scale[2], 65535.f));
+      q.attribute[i] = uint8_t(
+          quantize(attributes[i], attrLo, c.attributeScale, 255.f));
+    }
+  }
+  return q;
+}
+
+static void decodeClusterScalar(const QuantizedSpheres &q,
+    const QuantizedSpheres::Cluster &c,
+    uint32_t begin,
+    float3 *positions,
+    float *attributes)
+{
+  for (uint32_t i = begin; i < c.first + c.count; i++) {
+    positions[i] = float3(c.origin[0] + q.x[i] * c.scale[0],
+        c.origin[1] + q.y[i] * c.scale[1],
+        c.origin[2] + q.z[i] * c.scale[2]);
+    attributes[i] = c.attributeMin + q.attribute[i] * c.attributeScale;
+  }
+}
+
+static void decodeCluster(const QuantizedSpheres &q,
+    const QuantizedSpheres::Cluster &c,
+    float3 *positions,
+    float *attributes)
+{
+  uint32_t i = c.first;
+#ifdef __SSE2__
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 ox = _mm_set1_ps(c.origin[0]), sx = _mm_set1_ps(c.scale[0]);
+  const __m128 oy = _mm_set1_ps(c.origin[1]), sy = _mm_set1_ps(c.scale[1]);
+  const __m128 oz = _mm_set1_ps(c.origin[2]), sz = _mm_set1_ps(c.scale[2]);
+  const __m128 oa = _mm_set1_ps(c.attributeMin);
+  const __m128 sa = _mm_set1_ps(c.attributeScale);
+
+  auto widen16 = [&](const uint16_t *p) {
+    const __m128i v = _mm_loadl_epi64((const __m128i *)p);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+  };
+
+  for (; i + 4 <= c.first + c.count; i += 4) {
+    const __m128 X = _mm_add_ps(ox, _mm_mul_ps(widen16(&q.x[i]), sx));
+    const __m128 Y = _mm_add_ps(oy, _mm_mul_ps(widen16(&q.y[i]), sy));
+    const __m128 Z = _mm_add_ps(oz, _mm_mul_ps(widen16(&q.z[i]), sz));
+
+    // SoA -> AoS: (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+    const __m128 xy01 = _mm_unpacklo_ps(X, Y);
+    const __m128 xy23 = _mm_unpackhi_ps(X, Y);
+    const __m128 z0x1 = _mm_shuffle_ps(Z, X, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128 y1z1 = _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z2x3 = _mm_shuffle_ps(Z, X, _MM_SHUFFLE(3, 3, 2, 2));
+    const __m128 y3z3 = _mm_shuffle_ps(Y, Z, _MM_SHUFFLE(3, 3, 3, 3));
+    float *out = &positions[i][0];
+    _mm_storeu_ps(out + 0, _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    int packed;
+    std::memcpy(&packed, &q.attribute[i], sizeof(packed));
+    const __m128i a8 = _mm_cvtsi32_si128(packed);
+    const __m128i a32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a8, zero), zero);
+    _mm_storeu_ps(attributes + i,
+        _mm_add_ps(oa, _mm_mul_ps(_mm_cvtepi32_ps(a32), sa)));
+  }
+#endif
+  decodeClusterScalar(q, c, i, positions, attributes);
+}
+
+static void runQuantizedStorage(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  SphereSet set;
+  set.numSpheres = opts.numSpheres;
+  const uint32_t n = set.numSpheres;
+  std::vector<float3> positions(n);
+  std::vector<float> distances(n);
+  generateSpheres(
+      set, sceneCenter, positions.data(), distances.data(), nullptr);
+
+  auto encodeBegin = Clock::now();
+  const auto q = quantizeSpheres(positions.data(), distances.data(), n);
+  const double encodeMS = elapsedMS(encodeBegin, Clock::now());
+
+  const size_t rawBytes = size_t(n) * (sizeof(float3) + sizeof(float));
+  printf("%u spheres in %zu clusters: %.2f MB -> %.2f MB (%.2fx), "
+         "encoded in %.3fms\n",
+      n,
+      q.clusters.size(),
+      rawBytes / 1e6,
+      q.bytes() / 1e6,
+      double(rawBytes) / q.bytes(),
+      encodeMS);
+
+  // Decode into mapped device arrays, as a scene cache loader would //
+
+  auto positionsArray = tracked(
+      device, anari::newArray1D(device, ANARI_FLOAT32_VEC3, n), __func__);
+  auto distanceArray = tracked(
+      device, anari::newArray1D(device, ANARI_FLOAT32, n), __func__);
+
+  printf("%-16s %8s %12s %14s %14s\n",
+      "decoder", "threads", "decode[ms]", "out[GB/s]", "in[GB/s]");
+  for (const KernelVariant &v : kernelVariants(opts.numThreads)) {
+    std::vector<double> decodeMS;
+    for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+      auto begin = Clock::now();
+      auto *p = anari::map<float3>(device, positionsArray);
+      auto *a = anari::map<float>(device, distanceArray);
+      parallelFor(q.clusters.size(), v.threads, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; c++) {
+          if (v.simd)
+            decodeCluster(q, q.clusters[c], p, a);
+          else
+            decodeClusterScalar(q, q.clusters[c], q.clusters[c].first, p, a);
+        }
+      });
+      anari::unmap(device, positionsArray);
+      anari::unmap(device, distanceArray);
+      if (i >= opts.numWarmupFrames)
+        decodeMS.push_back(elapsedMS(begin, Clock::now()));
+    }
+
+    const double ms = computeStats(decodeMS).mean;
+    printf("%-16s %8d %12.3f %14.2f %14.2f\n",
+        v.name, v.threads, ms, rawBytes / (ms * 1e6), q.bytes() / (ms * 1e6));
+  }
+
+  // Accuracy, relative to the sphere radius and attribute range //
+
+  float maxPositionError = 0.f, maxAttributeError = 0.f;
+  double meanPositionError = 0.0;
+  {
+    auto *p = anari::map<float3>(device, positionsArray);
+    auto *a = anari::map<float>(device, distanceArray);
+    for (uint32_t i = 0; i < n; i++) {
+      const uint32_t j = q.order[i];
+      const float error = length(p[i] - positions[j]);
+      maxPositionError = std::max(maxPositionError, error);
+      meanPositionError += error / n;
+      maxAttributeError =
+          std::max(maxAttributeError, std::abs(a[i] - distances[j]));
+    }
+    anari::unmap(device, positionsArray);
+    anari::unmap(device, distanceArray);
+  }
+  // What the clusters buy: their extent, and so their quantization step
+  // and error, against a single 16-bit quantization of the whole set
+
+  float3 lo = positions[0], hi = positions[0];
+  for (const auto &p : positions) {
+    lo = min(lo, p);
+    hi = max(hi, p);
+  }
+  const float3 globalScale = max(hi - lo, float3(1e-20f)) / 65535.f;
+  double meanGlobalError = 0.0;
+  float maxGlobalError = 0.f;
+  for (const auto &p : positions) {
+    float3 r;
+    for (int d = 0; d < 3; d++) {
+      r[d] = lo[d]
+          + std::nearbyint((p[d] - lo[d]) / globalScale[d]) * globalScale[d];
+    }
+    const float error = length(r - p);
+    maxGlobalError = std::max(maxGlobalError, error);
+    meanGlobalError += error / n;
+  }
+
+  double meanExtent = 0.0;
+  float maxExtent = 0.f;
+  for (const auto &c : q.clusters) {
+    const float extent =
+        65535.f * std::max({c.scale[0], c.scale[1], c.scale[2]});
+    meanExtent += extent / q.clusters.size();
+    maxExtent = std::max(maxExtent, extent);
+  }
+  printf("cluster extent: mean %.3g, max %.3g vs. %.3g for the whole set\n",
+      meanExtent,
+      maxExtent,
+      std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]}));
+  printf("position error: mean %.3g, max %.3g (%.2f%% of radius); "
+         "global 16-bit: mean %.3g, max %.3g\n",
+      meanPositionError,
+      maxPositionError,
+      100.f * maxPositionError / set.radius,
+      meanGlobalError,
+      maxGlobalError);
+  printf("attribute error: max %.3g\n", maxAttributeError);
+
+  // Render decoded vs. original data //
+
+  auto decoded = tracked(
+      device, anari::newObject<anari::Geometry>(device, "sphere"), __func__);
+  anari::setAndReleaseParameter(
+      device, decoded, "vertex.position", positionsArray);
+  anari::setAndReleaseParameter(
+      device, decoded, "vertex.attribute0", distanceArray);
+  anari::setParameter(device, decoded, "radius", set.radius);
+  anari::commitParameters(device, decoded);
+
+  auto original = newSphereGeometry(
+      device, positions.data(), distances.data(), n, set.radius);
+
+  Scene scene = createScene(device);
+  std::vector<unsigned char> images[2];
+  int idx = 0;
+  for (auto geometry : {original, decoded}) {
+    initializeWorld(device, scene.world, geometry);
+    renderFrame(device, scene.frame);
+    images[idx++] = readColor(device, scene.frame);
+  }
+  printf("image error decoded vs. original: %.3f/255\n",
+      imageError(images[0], images[1]));
+
+  anari::release(device, original);
+  anari::release(device, decoded);
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Float color conversion: device-side sRGB (UFIXED8_RGBA_SRGB)
+//  vs. app-side tone mapping of a FLOAT32_VEC4 color channel
+// ========================================================
+static void runToneMapping(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  auto asBytes = [](const std::vector<uint32_t> &pixels) {
+    const auto *p = (const unsigned char *)pixels.data();
+    return std::vector<unsigned char>(p, p + 4 * pixels.size());
+  };
+
+  printf("%-16s %8s %12s %12s %12s %12s\n",
+      "conversion", "threads", "render[ms]", "convert[ms]", "Mpixel/s",
+      "total[ms]");
+  auto report = [&](const char *name,
+                    int threads,
+                    const std::vector<double> &renderMS,
+                    const std::vector<double> &convertMS,
+                    size_t numPixels) {
+    const double r = computeStats(renderMS).mean;
+    const double c = computeStats(convertMS).mean;
+    printf("%-16s %8d %12.3f %12.3f %12.1f %12.3f\n",
+        name, threads, r, c, numPixels / (c * 1e3), r + c);
+  };
+
+  // Device-side: sRGB RGBA8 channel, the app only reads it back //
+
+  std::vector<uint32_t> deviceImage;
+  {
+    std::vector<double> renderMS, convertMS;
+    for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+      auto begin = Clock::now();
+      renderFrame(device, scene.frame);
+      auto rendered = Clock::now();
+      auto fb = anari::map<uint32_t>(device, scene.frame, "channel.color");
+      deviceImage.assign(fb.data, fb.data + size_t(fb.width) * fb.height);
+      anari::unmap(device, scene.frame, "channel.color");
+      if (i >= opts.numWarmupFrames) {
+        renderMS.push_back(elapsedMS(begin, rendered));
+        convertMS.push_back(elapsedMS(rendered, Clock::now()));
+      }
+    }
+    report("device sRGB", 1, renderMS, convertMS, deviceImage.size());
+  }
+
+  // App-side: float channel converted straight from the mapped frame //
+
+  anari::setParameter(device, scene.frame, "channel.color", ANARI_FLOAT32_VEC4);
+  anari::commitParameters(device, scene.frame);
+
+  std::vector<uint32_t> appImage;
+  uint32_t width = 0, height = 0;
+  for (const KernelVariant &v : kernelVariants(opts.numThreads)) {
+    std::vector<double> renderMS, convertMS;
+    for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+      auto begin = Clock::now();
+      renderFrame(device, scene.frame);
+      auto rendered = Clock::now();
+      auto fb = anari::map<float4>(device, scene.frame, "channel.color");
+      width = fb.width;
+      height = fb.height;
+      appImage.resize(size_t(width) * height);
+      parallelFor(appImage.size(), v.threads, [&](size_t b, size_t e) {
+        if (v.simd)
+          convertToRGBA8(fb.data, appImage.data(), b, e, opts.toneMap);
+        else
+          convertToRGBA8Scalar(fb.data, appImage.data(), b, e, opts.toneMap);
+      });
+      anari::unmap(device, scene.frame, "channel.color");
+      if (i >= opts.numWarmupFrames) {
+        renderMS.push_back(elapsedMS(begin, rendered));
+        convertMS.push_back(elapsedMS(rendered, Clock::now()));
+      }
+    }
+    report((std::string("app ") + v.name).c_str(),
+        v.threads,
+        renderMS,
+        convertMS,
+        appImage.size());
+  }
+
+  // Accuracy: SIMD vs. scalar, and plain sRGB vs. the device's //
+
+  {
+    std::vector<uint32_t> scalar(appImage.size()), plain(appImage.size());
+    auto fb = anari::map<float4>(device, scene.frame, "channel.color");
+    convertToRGBA8Scalar(
+        fb.data, scalar.data(), 0, scalar.size(), opts.toneMap);
+    convertToRGBA8(fb.data, plain.data(), 0, plain.size(), ToneMapParams{});
+    anari::unmap(device, scene.frame, "channel.color");
+    printf("image error simd vs. scalar (%s, exposure %.2f): %.3f/255\n",
+        toneMapName(opts.toneMap.op),
+        opts.toneMap.exposure,
+        imageError(asBytes(appImage), asBytes(scalar)));
+    printf("image error app vs. device sRGB (no tone map): %.3f/255\n",
+        imageError(asBytes(plain), asBytes(deviceImage)));
+  }
+  printImageStats("float frame stats",
+      computeFrameStats(device, scene.frame, opts.numThreads));
+
+  writeImage(
+      std::string("out_tonemap.") + imageFormatExtension(opts.imageFormat),
+      (const unsigned char *)appImage.data(),
+      width,
+      height,
+      opts.imageFormat);
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Region of interest: render only a moving lens rectangle
+//  of the image via the camera image region, and sweep its
+//  size to see whether render time follows the lens area
+// ========================================================
+static void runRegionOfInterest(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+  const uint2 imageSize = {1024, 1024};
+
+  // Lens: same view as the scene camera, but a sub-rectangle of the sensor //
+
+  auto lensCamera = tracked(device,
+      anari::newObject<anari::Camera>(device, "perspective"),
+      __func__);
+  anari::setParameter(
+      device, lensCamera, "aspect", float(imageSize[0]) / imageSize[1]);
+  initializeCamera(device, lensCamera);
+  auto lensFrame =
+      tracked(device, anari::newObject<anari::Frame>(device), __func__);
+  initializeFrame(device, lensFrame, scene.world, scene.renderer, lensCamera);
+
+  // Lower-left lens corner in pixels, on a Lissajous path over the image
+  auto lensOrigin = [&](int i, uint32_t size) {
+    const float t = 6.2831853f * i / std::max(1, opts.numFrames);
+    const float cx = imageSize[0] * (0.5f + 0.35f * std::cos(t));
+    const float cy = imageSize[1] * (0.5f + 0.35f * std::sin(2.f * t));
+    const float maxX = float(imageSize[0] - size);
+    const float maxY = float(imageSize[1] - size);
+    return uint2(uint32_t(std::clamp(cx - size / 2.f, 0.f, maxX)),
+        uint32_t(std::clamp(cy - size / 2.f, 0.f, maxY)));
+  };
+  auto placeLens = [&](uint2 origin, uint32_t size) {
+    const box2 region = {
+        float2(float(origin[0]) / imageSize[0],
+            float(origin[1]) / imageSize[1]),
+        float2(float(origin[0] + size) / imageSize[0],
+            float(origin[1] + size) / imageSize[1])};
+    anari::setParameter(device, lensCamera, "imageRegion", region);
+    anari::commitParameters(device, lensCamera);
+  };
+  auto resizeLens = [&](uint32_t size) {
+    anari::setParameter(device, lensFrame, "size", uint2(size, size));
+    anari::commitParameters(device, lensFrame);
+  };
+
+  // Frame times include moving the lens (camera commit), as a magnifier
+  // view would every frame
+
+  printf("%-12s %10s %12s %14s %10s %12s\n",
+      "region", "pixels[%]", "frame[ms]", "duration[ms]", "vs. full",
+      "ms/Mpixel");
+
+  std::vector<double> fullMS, fullDuration;
+  for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+    auto begin = Clock::now();
+    const float duration = renderFrame(device, scene.frame);
+    if (i >= opts.numWarmupFrames) {
+      fullMS.push_back(elapsedMS(begin, Clock::now()));
+      fullDuration.push_back(duration * 1000.0);
+    }
+  }
+  const double full = computeStats(fullMS).mean;
+  const double fullPixels = double(imageSize[0]) * imageSize[1];
+  printf("%-12s %10.1f %12.3f %14.3f %10.2f %12.3f\n",
+      "full", 100.0, full, computeStats(fullDuration).mean, 1.0,
+      full / (fullPixels / 1e6));
+
+  std::vector<double> pixels, frameMS;
+  for (uint32_t size = 64; size <= imageSize[0]; size *= 2) {
+    resizeLens(size);
+    std::vector<double> lensMS, lensDuration;
+    for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+      auto begin = Clock::now();
+      placeLens(lensOrigin(i, size), size);
+      const float duration = renderFrame(device, lensFrame);
+      if (i >= opts.numWarmupFrames) {
+        lensMS.push_back(elapsedMS(begin, Clock::now()));
+        lensDuration.push_back(duration * 1000.0);
+      }
+    }
+    const double ms = computeStats(lensMS).mean;
+    const double n = double(size) * size;
+    pixels.push_back(n);
+    frameMS.push_back(ms);
+
+    char label[32];
+    snprintf(label, sizeof(label), "lens %ux%u", size, size);
+    printf("%-12s %10.1f %12.3f %14.3f %10.2f %12.3f\n",
+        label, 100.0 * n / fullPixels, ms, computeStats(lensDuration).mean,
+        ms / full, ms / (n / 1e6));
+  }
+
+  // Least-squares fit frame[ms] = fixed + perPixel * pixels //
+
+  const double meanN =
+      std::accumulate(pixels.begin(), pixels.end(), 0.0) / pixels.size();
+  const double meanT =
+      std::accumulate(frameMS.begin(), frameMS.end(), 0.0) / frameMS.size();
+  double sxy = 0.0, sxx = 0.0;
+  for (size_t k = 0; k < pixels.size(); k++) {
+    sxy += (pixels[k] - meanN) * (frameMS[k] - meanT);
+    sxx += (pixels[k] - meanN) * (pixels[k] - meanN);
+  }
+  const double perPixel = sxx > 0.0 ? sxy / sxx : 0.0;
+  const double fixed = meanT - perPixel * meanN;
+  printf("fit: %.3fms fixed + %.3fms/Mpixel "
+         "(fixed share at 256x256: %.0f%%)\n",
+      fixed,
+      perPixel * 1e6,
+      100.0 * fixed / std::max(1e-9, fixed + perPixel * 256.0 * 256.0));
+
+  // The lens must match the same pixels of the full frame //
+
+  const uint32_t size = std::min(256u, imageSize[0]);
+  const uint2 origin = lensOrigin(opts.numFrames / 3, size);
+  resizeLens(size);
+  placeLens(origin, size);
+  renderFrame(device, lensFrame);
+  const auto lens = readColor(device, lensFrame);
+
+  const auto image = readColor(device, scene.frame);
+  std::vector<unsigned char> crop;
+  for (uint32_t y = origin[1]; y < origin[1] + size; y++) {
+    const auto *row =
+        image.data() + (size_t(y) * imageSize[0] + origin[0]) * 4;
+    crop.insert(crop.end(), row, row + size * 4);
+  }
+  printf("image error lens vs. full frame crop at (%u, %u): %.3f/255\n",
+      origin[0],
+      origin[1],
+      imageError(lens, crop));
+
+  writeImage(
+      std::string("out_roi.") + imageFormatExtension(opts.imageFormat),
+      lens.data(),
+      size,
+      size,
+      opts.imageFormat);
+
+  anari::release(device, lensCamera);
+  anari::release(device, lensFrame);
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Stereo and multi-view: N cameras on a horizontal baseline
+//  (eye separation apart), one frame each, rendered per
+//  tick back-to-back, issued together or from N threads
+// ========================================================
+struct View
+{
+  anari::Camera camera{nullptr};
+  anari::Frame frame{nullptr};
+};
+
+static std::vector<View> createViews(
+    anari::Device device, const Scene &scene, int numViews, float eyeSeparation)
+{
+  std::vector<View> views(numViews);
+  for (int k = 0; k < numViews; k++) {
+    auto &view = views[k];
+    view.camera = tracked(device,
+        anari::newObject<anari::Camera>(device, "perspective"),
+        __func__);
+    initializeCamera(device, view.camera);
+    const float offset = (k - 0.5f * (numViews - 1)) * eyeSeparation;
+    anari::setParameter(
+        device, view.camera, "position", sceneEye + float3(offset, 0.f, 0.f));
+    anari::commitParameters(device, view.camera);
+
+    view.frame =
+        tracked(device, anari::newObject<anari::Frame>(device), __func__);
+    initializeFrame(
+        device, view.frame, scene.world, scene.renderer, view.camera);
+  }
+  return views;
+}
+
+static void releaseViews(anari::Device device, std::vector<View> &views)
+{
+  for (auto &view : views) {
+    anari::release(device, view.camera);
+    anari::release(device, view.frame);
+  }
+  views.clear();
+}
+
+static void runMultiView(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  std::vector<int> counts;
+  for (int n : {1, 2, 4, 8, 12}) {
+    if (n < opts.numViews)
+      counts.push_back(n);
+  }
+  counts.push_back(opts.numViews);
+
+  printf("eye separation %.3f, %d frames per measurement\n",
+      opts.eyeSeparation,
+      opts.numFrames);
+  printf("%6s %14s %14s %14s %14s %12s %9s\n",
+      "views", "N singles[ms]", "sequential[ms]", "issued[ms]",
+      "threaded[ms]", "views/s", "speedup");
+
+  auto measure = [&](auto &&tick) {
+    return computeStats(
+        measureRepeated(opts.numWarmupFrames, opts.numFrames, tick))
+        .mean;
+  };
+
+  for (int n : counts) {
+    auto views = createViews(device, scene, n, opts.eyeSeparation);
+
+    // Baseline: the single scene frame rendered n times //
+
+    const double singles = measure([&]() {
+      for (int k = 0; k < n; k++)
+        renderFrame(device, scene.frame);
+    });
+
+    // One frame per view, each rendered and waited on in turn //
+
+    const double sequential = measure([&]() {
+      for (const auto &view : views)
+        renderFrame(device, view.frame);
+    });
+
+    // All renders issued from one thread, then waited on //
+
+    const double issued = measure([&]() {
+      for (const auto &view : views)
+        anari::render(device, view.frame);
+      for (const auto &view : views)
+        anari::wait(device, view.frame);
+    });
+
+    // One application thread per view //
+
+    const double threaded = measure([&]() {
+      std::vector<std::thread> threads;
+      for (const auto &view : views)
+        threads.emplace_back([&]() {
+          setThreadRole("viewThread");
+          renderFrame(device, view.frame);
+        });
+      for (auto &t : threads)
+        t.join();
+    });
+
+    const double best = std::min({sequential, issued, threaded});
+    printf("%6d %14.3f %14.3f %14.3f %14.3f %12.1f %8.2fx\n",
+        n, singles, sequential, issued, threaded, n * 1000.0 / best,
+        singles / best);
+
+    releaseViews(device, views);
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Camera types: the same scene seen through a perspective,
+//  orthographic and omnidirectional (equirectangular)
+//  camera, each if the device has its KHR extension
+// ========================================================
+static void runCameraTypes(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  // 2:1 sizes, as used for equirectangular 360 degree captures
+  const uint2 sizes[] = {{1024, 512}, {2048, 1024}, {4096, 2048}};
+
+  printf("%-16s %12s %12s %14s %12s\n",
+      "camera", "size", "frame[ms]", "duration[ms]", "Mpixel/s");
+
+  struct CameraType
+  {
+    const char *subtype;
+    const char *extension;
+  };
+  for (const CameraType &c :
+      {CameraType{"perspective", "ANARI_KHR_CAMERA_PERSPECTIVE"},
+          CameraType{"orthographic", "ANARI_KHR_CAMERA_ORTHOGRAPHIC"},
+          CameraType{"omnidirectional", "ANARI_KHR_CAMERA_OMNIDIRECTIONAL"}}) {
+    const char *type = c.subtype;
+    if (!deviceHasExtension(library, opts.deviceSubtype, c.extension)) {
+      printf("%-16s skipped, device lacks %s\n", type, c.extension);
+      continue;
+    }
+
+    auto camera = tracked(
+        device, anari::newObject<anari::Camera>(device, type), __func__);
+    initializeCamera(device, camera);
+    if (!strcmp(type, "orthographic")) // about the extent of the spheres
+      anari::setParameter(device, camera, "height", 2.f);
+    else if (!strcmp(type, "omnidirectional"))
+      anari::setParameter(device, camera, "layout", "equirectangular");
+    anari::commitParameters(device, camera);
+    anari::setParameter(device, scene.frame, "camera", camera);
+
+    for (const uint2 &size : sizes) {
+      if (strcmp(type, "omnidirectional")) {
+        anari::setParameter(
+            device, camera, "aspect", float(size[0]) / size[1]);
+        anari::commitParameters(device, camera);
+      }
+      anari::setParameter(device, scene.frame, "size", size);
+      anari::commitParameters(device, scene.frame);
+
+      std::vector<double> frameMS, durationMS;
+      for (int i = 0; i < opts.numWarmupFrames + opts.numFrames; i++) {
+        auto begin = Clock::now();
+        const float duration = renderFrame(device, scene.frame);
+        if (i >= opts.numWarmupFrames) {
+          frameMS.push_back(elapsedMS(begin, Clock::now()));
+          durationMS.push_back(duration * 1000.0);
+        }
+      }
+
+      const double ms = computeStats(frameMS).mean;
+      char label[32];
+      snprintf(label, sizeof(label), "%ux%u", size[0], size[1]);
+      printf("%-16s %12s %12.3f %14.3f %12.1f\n",
+          type, label, ms, computeStats(durationMS).mean,
+          double(size[0]) * size[1] / (ms * 1e3));
+
+      if (&size == &sizes[0]) {
+        writeFrame(device,
+            scene.frame,
+            std::string("out_camera_") + type + '.'
+                + imageFormatExtension(opts.imageFormat),
+            opts.imageFormat);
+      }
+    }
+
+    anari::setParameter(device, scene.frame, "camera", scene.camera);
+    anari::commitParameters(device, scene.frame);
+    anari::release(device, camera);
+  }
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Introspection: object subtypes, their parameter lists and
+//  per-parameter info, as a generic UI queries them to build
+//  property panels, directly or through a memoized cache
+// ========================================================
+struct ParameterDescription
+{
+  std::string name;
+  ANARIDataType type{ANARI_UNKNOWN};
+  std::string description;
+  bool required{false};
+};
+
+struct PanelDescription
+{
+  std::string description;
+  std::vector<ParameterDescription> parameters;
+  int numQueries{0}; // introspection calls it took to build
+};
+
+static const ANARIDataType introspectedTypes[] = {ANARI_ARRAY1D,
+    ANARI_ARRAY2D,
+    ANARI_ARRAY3D,
+    ANARI_CAMERA,
+    ANARI_FRAME,
+    ANARI_GEOMETRY,
+    ANARI_GROUP,
+    ANARI_INSTANCE,
+    ANARI_LIGHT,
+    ANARI_MATERIAL,
+    ANARI_RENDERER,
+    ANARI_SAMPLER,
+    ANARI_SPATIAL_FIELD,
+    ANARI_SURFACE,
+    ANARI_VOLUME,
+    ANARI_WORLD};
+
+// Types the device lists no subtypes for (frame, world, arrays, ...) get
+// a single panel, queried with a null subtype and listed as ""
+static std::vector<std::string> querySubtypes(
+    anari::Device device, ANARIDataType objectType)
+{
+  std::vector<std::string> subtypes;
+  const char **list = anariGetObjectSubtypes(device, objectType);
+  for (; list && *list; list++)
+    subtypes.push_back(*list);
+  if (subtypes.empty())
+    subtypes.emplace_back();
+  return subtypes;
+}
+
+static PanelDescription queryPanel(anari::Device device,
+    ANARIDataType objectType,
+    const std::string &subtypeName)
+{
+  const char *subtype = subtypeName.empty() ? nullptr : subtypeName.c_str();
+  PanelDescription panel;
+  panel.numQueries = 2;
+  if (auto *desc = (const char *)anariGetObjectInfo(
+          device, objectType, subtype, "description", ANARI_STRING))
+    panel.description = desc;
+
+  auto *params = (const ANARIParameter *)anariGetObjectInfo(
+      device, objectType, subtype, "parameter", ANARI_PARAMETER_LIST);
+  for (; params && params->name; params++) {
+    ParameterDescription p;
+    p.name = params->name;
+    p.type = params->type;
+    if (auto *desc = (const char *)anariGetParameterInfo(device,
+            objectType,
+            subtype,
+            params->name,
+            params->type,
+            "description",
+            ANARI_STRING))
+      p.description = desc;
+    if (auto *required = (const int32_t *)anariGetParameterInfo(device,
+            objectType,
+            subtype,
+            params->name,
+            params->type,
+            "required",
+            ANARI_BOOL))
+      p.required = *required;
+    panel.parameters.push_back(std::move(p));
+    panel.numQueries += 2;
+  }
+  return panel;
+}
+
+// Read-mostly: lookups share the lock; a miss queries the device without
+// holding it, and the first of racing inserts wins
+struct IntrospectionCache
+{
+  std::shared_mutex mutex;
+  std::map<ANARIDataType, std::vector<std::string>> subtypes;
+  std::map<std::pair<ANARIDataType, std::string>,
+      std::shared_ptr<const PanelDescription>>
+      panels;
+
+  const std::vector<std::string> &getSubtypes(
+      anari::Device device, ANARIDataType objectType)
+  {
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      auto it = subtypes.find(objectType);
+      if (it != subtypes.end())
+        return it->second;
+    }
+    auto list = querySubtypes(device, objectType);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return subtypes.emplace(objectType, std::move(list)).first->second;
+  }
+
+  std::shared_ptr<const PanelDescription> getPanel(anari::Device device,
+      ANARIDataType objectType,
+      const std::string &subtype)
+  {
+    const auto key = std::make_pair(objectType, subtype);
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex);
+      auto it = panels.find(key);
+      if (it != panels.end())
+        return it->second;
+    }
+    auto panel = std::make_shared<const PanelDescription>(
+        queryPanel(device, objectType, subtype));
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return panels.emplace(key, std::move(panel)).first->second;
+  }
+};
+
+static void runIntrospection(
+    const Options &opts, anari::Library /*library*/, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  size_t numSubtypes = 0, numParameters = 0;
+  int queriesPerSweep = 0;
+  for (auto type : introspectedTypes) {
+    queriesPerSweep++;
+    for (const auto &subtype : querySubtypes(device, type)) {
+      const auto panel = queryPanel(device, type, subtype);
+      numSubtypes++;
+      numParameters += panel.parameters.size();
+      queriesPerSweep += panel.numQueries;
+    }
+  }
+  printf("%zu object types, %zu panels, %zu parameters: "
+         "%d introspection calls per sweep over all panels\n",
+      std::size(introspectedTypes),
+      numSubtypes,
+      numParameters,
+      queriesPerSweep);
+
+  printf("%-8s %8s %10s %10s %10s %10s %14s %10s\n",
+      "queries", "threads", "panels", "mean[us]", "p50[us]", "p99[us]",
+      "panels/s", "frame[ms]");
+
+  // Every thread sweeps all panels (after warmup sweeps) numFrames times,
+  // while the render thread keeps rendering as behind a live UI. Panel
+  // times are sweep times over the number of panels
+  auto measure = [&](const char *name, int numThreads, auto &&buildPanel) {
+    std::atomic<bool> finish{false};
+    std::vector<double> frameTimes;
+    std::thread renderThread([&]() {
+      setThreadRole("renderThread");
+      while (!finish) {
+        auto begin = Clock::now();
+        renderFrame(device, scene.frame);
+        frameTimes.push_back(elapsedMS(begin, Clock::now()));
+      }
+    });
+
+    std::vector<std::vector<double>> panelUS(numThreads);
+    auto begin = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+      threads.emplace_back([&, t]() {
+        setThreadRole("panelThread");
+        const auto sweepMS =
+            measureRepeated(opts.numWarmupFrames, opts.numFrames, [&]() {
+              for (auto type : introspectedTypes)
+                buildPanel(type);
+            });
+        for (double ms : sweepMS)
+          panelUS[t].push_back(1e3 * ms / std::max<size_t>(1, numSubtypes));
+      });
+    }
+    for (auto &t : threads)
+      t.join();
+    const double totalMS = elapsedMS(begin, Clock::now());
+    finish = true;
+    renderThread.join();
+
+    std::vector<double> all;
+    for (const auto &samples : panelUS)
+      all.insert(all.end(), samples.begin(), samples.end());
+    const auto stats = computeStats(all);
+    const double numPanels = double(numThreads) * opts.numFrames
+        * std::max<size_t>(1, numSubtypes);
+    printf("%-8s %8d %10.0f %10.2f %10.2f %10.2f %14.0f %10.3f\n",
+        name, numThreads, numPanels, stats.mean, stats.p50, stats.p99,
+        numPanels / (totalMS * 1e-3), computeStats(frameTimes).mean);
+  };
+
+  // Each call builds the panels of all subtypes of one object type
+  for (int threads : {1, opts.numThreads}) {
+    measure("direct", threads, [&](ANARIDataType type) {
+      const auto subtypes = querySubtypes(device, type);
+      for (const auto &subtype : subtypes)
+        queryPanel(device, type, subtype);
+    });
+    if (opts.numThreads == 1)
+      break;
+  }
+
+  IntrospectionCache cache;
+  for (int threads : {1, opts.numThreads}) {
+    measure("cached", threads, [&](ANARIDataType type) {
+      const auto &subtypes = cache.getSubtypes(device, type);
+      for (const auto &subtype : subtypes)
+        cache.getPanel(device, type, subtype);
+    });
+    if (opts.numThreads == 1)
+      break;
+  }
+
+  // The cache must hand out what the device reports //
+
+  size_t mismatches = 0;
+  for (auto type : introspectedTypes) {
+    for (const auto &subtype : querySubtypes(device, type)) {
+      const auto direct = queryPanel(device, type, subtype);
+      const auto cached = cache.getPanel(device, type, subtype);
+      mismatches += direct.description != cached->description
+          || direct.parameters.size() != cached->parameters.size();
+    }
+  }
+  printf("cached panels differing from direct queries: %zu\n", mismatches);
+
+  releaseScene(device, scene);
+}
+
+// ========================================================
+// Core-count scaling: restrict the process affinity mask
+//  before the device is created, one child process per step
+// ========================================================
+#ifdef __linux__
+static int readTopologyValue(int cpu, const char *name)
+{
+  char path[128];
+  snprintf(path, sizeof(path),
+      "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  int value = -1;
+  if (FILE *fp = fopen(path, "r")) {
+    if (fscanf(fp, "%d", &value) != 1)
+      value = -1;
+    fclose(fp);
+  }
+  return value;
+}
+
+// Usable CPUs ordered so that the first n cover n distinct physical cores
+// (SMT siblings come last), optionally restricted to a single socket
+static std::vector<int> scalingCPUOrder(int socket)
+{
+  cpu_set_t available;
+  CPU_ZERO(&available);
+  sched_getaffinity(0, sizeof(available), &available);
+
+  struct CPU
+  {
+    int id, package, core, sibling;
+  };
+  std::vector<CPU> cpus;
+  for (int id = 0; id < CPU_SETSIZE; id++) {
+    if (!CPU_ISSET(id, &available))
+      continue;
+    const int package = readTopologyValue(id, "physical_package_id");
+    if (socket >= 0 && package != socket)
+      continue;
+    cpus.push_back({id, package, readTopologyValue(id, "core_id"), 0});
+  }
+
+  for (size_t i = 0; i < cpus.size(); i++) {
+    for (size_t j = 0; j < i; j++) {
+      if (cpus[j].package == cpus[i].package && cpus[j].core == cpus[i].core)
+        cpus[i].sibling++;
+    }
+  }
+
+  std::stable_sort(cpus.begin(), cpus.end(), [](const CPU &a, const CPU &b) {
+    return a.sibling < b.sibling;
+  });
+
+  std::vector<int> order;
+  for (const auto &c : cpus)
+    order.push_back(c.id);
+  return order;
+}
+
+static double measureOnCPUs(const Options &opts, const std::vector<int> &cpus)
+{
+  int fds[2];
+  if (pipe(fds) != 0)
+    return -1.0;
+
+  fflush(stdout); // or the child repeats what is still buffered
+  pid_t pid = fork();
+  if (pid == 0) {
+    setThreadRole("scalingChild");
+    close(fds[0]);
+
+    // Threads created from here on (including device-internal worker
+    // pools) inherit the restricted mask
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int c : cpus)
+      CPU_SET(c, &mask);
+    double result = -1.0;
+    if (sched_setaffinity(0, sizeof(mask), &mask) == 0) {
+      auto library = anari::loadLibrary(opts.libraryName.c_str(), statusFunc);
+      auto device = anari::newDevice(library, opts.deviceSubtype.c_str());
+      StatusRegistry status;
+      attachStatusRegistry(
+          device, status, "scaling, " + std::to_string(cpus.size()) + " CPUs");
+      Scene scene = createScene(device);
+
+      const unsigned activities = (1u << FACTOR_EXTENSIONS)
+          | (1u << FACTOR_BOUNDS_WAIT) | (1u << FACTOR_BOUNDS_NO_WAIT)
+          | (1u << FACTOR_READBACK);
+      result = computeStats(
+          measureWithActivities(opts, library, device, scene, activities))
+                   .mean;
+
+      releaseScene(device, scene);
+      anari::release(device, device);
+      detachStatusRegistry(device);
+      anari::unloadLibrary(library);
+    } else {
+      perror("sched_setaffinity");
+    }
+
+    if (write(fds[1], &result, sizeof(result)) != sizeof(result))
+      result = -1.0;
+    close(fds[1]);
+    fflush(stdout); // _exit does not flush the status summary
+    _exit(result < 0.0 ? 1 : 0);
+  }
+
+  close(fds[1]);
+  double result = -1.0;
+  if (pid < 0 || read(fds[0], &result, sizeof(result)) != sizeof(result))
+    result = -1.0;
+  close(fds[0]);
+  if (pid > 0)
+    waitpid(pid, nullptr, 0);
+  return result;
+}
+
+static int runCoreScalingSweep(const Options &opts)
+{
+  const auto order = scalingCPUOrder(opts.socket);
+  if (order.empty()) {
+    if (opts.socket >= 0)
+      fprintf(stderr, "no usable CPUs on socket %d\n", opts.socket);
+    else
+      fprintf(stderr, "no usable CPUs\n");
+    return 1;
+  }
+
+  std::vector<size_t> counts;
+  for (size_t n = 1; n < order.size(); n *= 2)
+    counts.push_back(n);
+  counts.push_back(order.size());
+
+  printf("%8s %12s %10s %12s  %s\n",
+      "cores", "mean[ms]", "speedup", "efficiency", "cpus");
+
+  double reference = 0.0;
+  for (size_t n : counts) {
+    std::vector<int> cpus(order.begin(), order.begin() + n);
+    const double ms = measureOnCPUs(opts, cpus);
+    if (ms < 0.0) {
+      fprintf(stderr, "measurement on %zu cores failed\n", n);
+      return 1;
+    }
+    if (reference == 0.0)
+      reference = ms;
+
+    std::string cpuList;
+    for (int c : cpus)
+      cpuList += (cpuList.empty() ? "" : ",") + std::to_string(c);
+
+    const double speedup = reference / ms;
+    printf("%8zu %12.3f %10.2f %11.1f%%  %s\n",
+        n, ms, speedup, 100.0 * speedup / n, cpuList.c_str());
+  }
+  return 0;
+}
+#else
+static int runCoreScalingSweep(const Options &)
+{
+  fprintf(stderr, "core-count scaling sweep is only supported on Linux\n");
+  return 1;
+}
+#endif
+
+// ========================================================
+// Sort-last compositing: keep the fragment with the
+//  smaller depth, 4 (SSE2) pixels at a time
+// ========================================================
+static void depthComposite(uint32_t *dstColor,
+    float *dstDepth,
+    const uint32_t *srcColor,
+    const float *srcDepth,
+    size_t numPixels)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  for (; i + 4 <= numPixels; i += 4) {
+    const __m128 dd = _mm_loadu_ps(dstDepth + i);
+    const __m128 sd = _mm_loadu_ps(srcDepth + i);
+    const __m128i dc = _mm_loadu_si128((const __m128i *)(dstColor + i));
+    const __m128i sc = _mm_loadu_si128((const __m128i *)(srcColor + i));
+    const __m128 closer = _mm_cmplt_ps(sd, dd);
+    const __m128i mask = _mm_castps_si128(closer);
+    const __m128i color = _mm_or_si128(
+        _mm_and_si128(mask, sc), _mm_andnot_si128(mask, dc));
+    _mm_storeu_ps(dstDepth + i, _mm_min_ps(sd, dd));
+    _mm_storeu_si128((__m128i *)(dstColor + i), color);
+  }
+#endif
+  for (; i < numPixels; i++) {
+    if (srcDepth[i] < dstDepth[i]) {
+      dstDepth[i] = srcDepth[i];
+      dstColor[i] = srcColor[i];
+    }
+  }
+}
+
+// ========================================================
+// Multi-process sort-last rendering: every process renders
+//  a disjoint part of the spheres, the parent composites
+// ========================================================
+#ifdef __linux__
+struct SortLastShared
+{
+  sem_t ready; // posted by a renderer when its layer is in place
+  sem_t go[64]; // posted by the compositor to start a renderer's frame
+  int quit;
+  double renderMS[64];
+};
+
+static void sortLastRenderer(const Options &opts,
+    SortLastShared *shared,
+    uint32_t *color,
+    float *depth,
+    int part,
+    int numParts)
+{
+  setThreadRole("sortLastRenderer");
+  auto library = anari::loadLibrary(opts.libraryName.c_str(), statusFunc);
+  auto device = anari::newDevice(library, opts.deviceSubtype.c_str());
+  StatusRegistry status;
+  attachStatusRegistry(device, status, "sortlast part " + std::to_string(part));
+  SphereSet set;
+  set.partIndex = part;
+  set.numParts = numParts;
+  Scene scene = createScene(device, set);
+  anari::setParameter(device, scene.frame, "channel.depth", ANARI_FLOAT32);
+  anari::commitParameters(device, scene.frame);
+
+  for (;;) {
+    sem_wait(&shared->go[part]);
+    if (shared->quit)
+      break;
+
+    auto begin = Clock::now();
+    renderFrame(device, scene.frame);
+    auto fbColor = anari::map<uint32_t>(device, scene.frame, "channel.color");
+    auto fbDepth = anari::map<float>(device, scene.frame, "channel.depth");
+    const size_t numPixels = size_t(fbColor.width) * fbColor.height;
+    std::copy(fbColor.data, fbColor.data + numPixels, color);
+    std::copy(fbDepth.data, fbDepth.data + numPixels, depth);
+    anari::unmap(device, scene.frame, "channel.depth");
+    anari::unmap(device, scene.frame, "channel.color");
+    shared->renderMS[part] = elapsedMS(begin, Clock::now());
+
+    sem_post(&shared->ready);
+  }
+
+  releaseScene(device, scene);
+  anari::release(device, device);
+  detachStatusRegistry(device);
+  anari::unloadLibrary(library);
+}
+
+static int runSortLast(const Options &opts)
+{
+  const int numParts = std::clamp(opts.numProcesses, 1, 64);
+  const size_t numPixels = 1024 * 1024;
+  const size_t layerBytes = numPixels * (sizeof(uint32_t) + sizeof(float));
+  const size_t sharedBytes = sizeof(SortLastShared) + numParts * layerBytes;
+
+  // Anonymous shared mapping, inherited by the forked renderers //
+
+  void *mem = mmap(nullptr,
+      sharedBytes,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (mem == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+
+  auto *shared = new (mem) SortLastShared;
+  shared->quit = 0;
+  sem_init(&shared->ready, 1, 0);
+  for (int k = 0; k < numParts; k++)
+    sem_init(&shared->go[k], 1, 0);
+
+  auto *layers = (char *)mem + sizeof(SortLastShared);
+  auto layerColor = [&](int k) { return (uint32_t *)(layers + k * layerBytes); };
+  auto layerDepth = [&](int k) {
+    return (float *)(layers + k * layerBytes + numPixels * sizeof(uint32_t));
+  };
+
+  std::vector<pid_t> children;
+  for (int k = 0; k < numParts; k++) {
+    fflush(stdout); // or the child repeats what is still buffered
+    pid_t pid = fork();
+    if (pid == 0) {
+      sortLastRenderer(
+          opts, shared, layerColor(k), layerDepth(k), k, numParts);
+      fflush(stdout); // _exit does not flush the status summary
+      _exit(0);
+    }
+    if (pid < 0) {
+      perror("fork");
+      break;
+    }
+    children.push_back(pid);
+  }
+
+  std::vector<uint32_t> color(numPixels);
+  std::vector<float> depth(numPixels);
+  std::vector<double> frameMS, renderMS, compositeMS;
+  bool ok = int(children.size()) == numParts;
+
+  for (int i = 0; ok && i < opts.numWarmupFrames + opts.numFrames; i++) {
+    auto begin = Clock::now();
+    for (int k = 0; k < numParts; k++)
+      sem_post(&shared->go[k]);
+
+    // Don't hang forever if a renderer died
+    for (int k = 0; ok && k < numParts; k++) {
+      timespec timeout;
+      clock_gettime(CLOCK_REALTIME, &timeout);
+      timeout.tv_sec += 60;
+      while (sem_timedwait(&shared->ready, &timeout) != 0) {
+        if (errno != EINTR) {
+          fprintf(stderr, "sort-last renderer did not respond\n");
+          ok = false;
+          break;
+        }
+      }
+    }
+    if (!ok)
+      break;
+
+    auto compositeBegin = Clock::now();
+    std::copy(layerColor(0), layerColor(0) + numPixels, color.begin());
+    std::copy(layerDepth(0), layerDepth(0) + numPixels, depth.begin());
+    for (int k = 1; k < numParts; k++) {
+      depthComposite(
+          color.data(), depth.data(), layerColor(k), layerDepth(k), numPixels);
+    }
+    auto end = Clock::now();
+
+    if (i >= opts.numWarmupFrames) {
+      frameMS.push_back(elapsedMS(begin, end));
+      compositeMS.push_back(elapsedMS(compositeBegin, end));
+      renderMS.push_back(*std::max_element(
+          shared->renderMS, shared->renderMS + numParts));
+    }
+  }
+
+  shared->quit = 1;
+  for (size_t k = 0; k < children.size(); k++)
+    sem_post(&shared->go[k]);
+  for (pid_t pid : children) {
+    if (!ok)
+      kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+
+  if (ok) {
+    writeImage(std::string("out_composited.")
+            + imageFormatExtension(opts.imageFormat),
+        (const unsigned char *)color.data(),
+        1024,
+        1024,
+        opts.imageFormat);
+
+    const auto frame = computeStats(frameMS);
+    const auto render = computeStats(renderMS);
+    const auto composite = computeStats(compositeMS);
+    printf("%d processes, %.1f MB shared\n", numParts, sharedBytes / 1e6);
+    printf("%-24s %10s %10s %10s\n", "[ms]", "mean", "p95", "max");
+    printf("%-24s %10.3f %10.3f %10.3f\n",
+        "frame", frame.mean, frame.p95, frame.max);
+    printf("%-24s %10.3f %10.3f %10.3f\n",
+        "slowest renderer", render.mean, render.p95, render.max);
+    printf("%-24s %10.3f %10.3f %10.3f\n",
+        "composite", composite.mean, composite.p95, composite.max);
+    printf("compositing overhead: %.1f%% of frame time, %.2f GB/s\n",
+        100.0 * composite.mean / frame.mean,
+        numParts * layerBytes / (composite.mean * 1e6));
+  }
+
+  sem_destroy(&shared->ready);
+  for (int k = 0; k < numParts; k++)
+    sem_destroy(&shared->go[k]);
+  munmap(mem, sharedBytes);
+  return ok ? 0 : 1;
+}
+#else
+static int runSortLast(const Options &)
+{
+  fprintf(stderr, "sort-last mode is only supported on Linux\n");
+  return 1;
+}
+#endif
+
+// ========================================================
+// Shared-memory framebuffer transport: publish every frame
+//  into a ring read by anari-shm-consumer
+// ========================================================
+#ifdef __linux__
+static void runSharedMemoryProducer(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  Scene scene = createScene(device);
+
+  const uint32_t numSlots =
+      std::clamp<uint32_t>(opts.numSharedSlots, 1, shmfb::kMaxSlots);
+  const uint64_t slotBytes = 1024 * 1024 * sizeof(uint32_t);
+  const size_t bytes = shmfb::totalBytes(numSlots, slotBytes);
+
+  // Always start from a fresh segment: a stale one (e.g. from a killed
+  // producer) may still be mapped by a consumer at its old size
+  shm_unlink(opts.sharedName.c_str());
+  int fd =
+      shm_open(opts.sharedName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0 || ftruncate(fd, bytes) != 0) {
+    perror("shm_open");
+    if (fd >= 0)
+      close(fd);
+    releaseScene(device, scene);
+    return;
+  }
+  void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mem == MAP_FAILED) {
+    perror("mmap");
+    shm_unlink(opts.sharedName.c_str());
+    releaseScene(device, scene);
+    return;
+  }
+
+  auto *header = new (mem) shmfb::Header;
+  header->magic = 0; // not reset by the placement new
+  header->numSlots = numSlots;
+  header->slotBytes = slotBytes;
+  header->published = 0;
+  header->closed = 0;
+  header->producerPid = int32_t(getpid());
+  for (auto &slot : header->slots)
+    slot.sequence = 0;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = shmfb::kMagic;
+
+  printf("publishing to %s (%u slots), start anari-shm-consumer %s\n",
+      opts.sharedName.c_str(), numSlots, opts.sharedName.c_str());
+
+  // Keep the usual query threads running next to the producer
+
+  ConcurrentActivities activities;
+  activities.start(opts, library, device, scene,
+      (1u << FACTOR_EXTENSIONS) | (1u << FACTOR_BOUNDS_WAIT)
+          | (1u << FACTOR_BOUNDS_NO_WAIT));
+
+  std::vector<double> publishMS;
+  for (uint32_t n = 1; n <= uint32_t(opts.numFrames); n++) {
+    renderFrame(device, scene.frame);
+    const uint64_t renderDoneNS = shmfb::nowNS();
+
+    // The mapped channel belongs to the device, so it has to be copied
+    auto fb = anari::map<uint32_t>(device, scene.frame, "channel.color");
+    const size_t frameBytes =
+        std::min<size_t>(size_t(fb.width) * fb.height * 4, slotBytes);
+    auto &slot = header->slots[(n - 1) % numSlots];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(shmfb::slotPixels(header, (n - 1) % numSlots),
+        fb.data,
+        frameBytes);
+    slot.width = fb.width;
+    slot.height = fb.height;
+    slot.renderDoneNS = renderDoneNS;
+    slot.publishNS = shmfb::nowNS();
+    slot.sequence.store(n, std::memory_order_release);
+    anari::unmap(device, scene.frame, "channel.color");
+
+    header->published.store(n, std::memory_order_release);
+    shmfb::futexWakeAll(header->published);
+
+    publishMS.push_back((slot.publishNS - renderDoneNS) / 1e6);
+  }
+
+  activities.stop();
+
+  header->closed = 1;
+  shmfb::futexWakeAll(header->published);
+
+  auto stats = computeStats(publishMS);
+  printf("published %d frames, map+copy: mean %.3fms, p95 %.3fms, %.2f GB/s\n",
+      opts.numFrames,
+      stats.mean,
+      stats.p95,
+      slotBytes / (stats.mean * 1e6));
+
+  munmap(mem, bytes);
+  shm_unlink(opts.sharedName.c_str());
+  releaseScene(device, scene);
+}
+#else
+static void runSharedMemoryProducer(
+    const Options &, anari::Library, anari::Device)
+{
+  fprintf(stderr, "shared-memory transport is only supported on Linux\n");
+}
+#endif
+
+// ========================================================
+// Default mode: initialize, query and render concurrently
+// ========================================================
+static void runDefault(
+    const Options &opts, anari::Library library, anari::Device device)
+{
+  // Create world from a helper function //
+
+  anari::World world =
+      tracked(device, anari::newObject<anari::World>(device), __func__);
+  std::thread initWorldThread([&]() {
+    setThreadRole("initWorldThread");
+    initializeWorld(device,
+        world,
+        sceneCenter,
+        SphereSet{},
+        opts.surfaceArrayPath);
+    fprintf(stdout, "%s\n", "world initialization thread finished");
+  });
+
+  // Create renderer //
+  anari::Renderer renderer = tracked(device,
+      anari::newObject<anari::Renderer>(device, "default"),
+      __func__);
+  std::thread initRendererThread([&]() {
+    setThreadRole("initRendererThread");
+    initializeRenderer(device, renderer);
+    fprintf(stdout, "%s\n", "renderer initialization thread finished");
+  });
+
+  // Create camera //
+
+  auto camera = tracked(device,
+      anari::newObject<anari::Camera>(device, "perspective"),
+      __func__);
+  std::thread initCameraThread([&]() {
+    setThreadRole("initCameraThread");
+    initializeCamera(device, camera);
+    fprintf(stdout, "%s\n", "camera initialization thread finished");
+  });
+
+  // Create frame (top-level object) //
+
+  auto frame =
+      tracked(device, anari::newObject<anari::Frame>(device), __func__);
+  std::thread initFrameThread([&]() {
+    setThreadRole("initFrameThread");
+    initializeFrame(device, frame, world, renderer, camera);
+    fprintf(stdout, "%s\n", "frame initialization thread finished");
+  });
+
+  // Periodically query some extensions //
+
+  std::atomic<bool> finish_queryExtension{false};
+  std::thread queryExtensionThread([&]() {
+    setThreadRole("queryExtensionThread");
+    queryExtensionLoop(library, opts.deviceSubtype, finish_queryExtension);
+    fprintf(stdout, "%s\n", "extension query thread finished");
+  });
+
+  // Periodically query world boudns //
+
+  std::atomic<bool> finish_queryBoundsNoWait{false};
+  std::thread queryBoundsNoWaitThread([&]() {
+    setThreadRole("queryBoundsNoWaitThread");
+    queryBoundsLoop(device, world, ANARI_NO_WAIT, finish_queryBoundsNoWait);
+    fprintf(stdout, "%s\n", "bounds query (no wait) thread finished");
+  });
+
+  std::atomic<bool> finish_queryBoundsWait{false};
+  std::thread queryBoundsWaitThread([&]() {
+    setThreadRole("queryBoundsWaitThread");
+    queryBoundsLoop(device, world, ANARI_WAIT, finish_queryBoundsWait);
+    fprintf(stdout, "%s\n", "bounds query (wait) thread finished");
+  });
+
+  // Rendering //
+  PreviewWriter preview;
+  if (opts.previewLevel > 0)
+    preview.start(opts.previewLevel, opts.imageFormat, opts.numThreads);
+
+  std::thread renderThread([&]() {
+    setThreadRole("renderThread");
+    for (int i=0; i<opts.numFrames; i++) {
+      std::stringstream str;
+      str << "out_" << i << '.' << imageFormatExtension(opts.imageFormat);
+      render(device,
+          frame,
+          str.str(),
+          opts.imageFormat,
+          opts.frameStats ? opts.numThreads : 0,
+          opts.previewLevel > 0 ? &preview : nullptr);
+    }
+
+    // Tell the periodic query threads to finish:
+    finish_queryExtension = true;
+    finish_queryBoundsNoWait = true;
+    finish_queryBoundsWait = true;
+
+    fprintf(stdout, "%s\n", "render thread finished");
+  });
+
+  // Join all threads //
+
+  renderThread.join();
+  if (opts.previewLevel > 0)
+    preview.stop();
+  queryBoundsWaitThread.join();
+  queryBoundsNoWaitThread.join();
+  queryExtensionThread.join();
+  initWorldThread.join();
+  initRendererThread.join();
+  initCameraThread.join();
+  initFrameThread.join();
+
+  // Cleanup remaining ANARI objets //
+
+  anari::release(device, camera);
+  anari::release(device, renderer);
+  anari::release(device, world);
+  anari::release(device, frame);
+}
+
+int main(int argc, char *argv[])
+{
+  Options opts;
+  if (!parseCommandLine(argc, argv, opts))
+    return 1;
+
+  // These modes set up their own devices in child processes //
+
+  if (opts.mode == "scaling")
+    return runCoreScalingSweep(opts);
+  else if (opts.mode == "sortlast")
+    return runSortLast(opts);
+
+  // Setup ANARI device //
+
+  setThreadRole("main");
+  auto library = anari::loadLibrary(opts.libraryName.c_str(), statusFunc);
+  auto device = anari::newDevice(library, opts.deviceSubtype.c_str());
+  StatusRegistry status;
+  attachStatusRegistry(device, status, "device");
+
+  int result = 0;
+  if (opts.mode == "default")
+    runDefault(opts, library, device);
+  else if (opts.mode == "interference")
+    runInterferenceMatrix(opts, library, device);
+  else if (opts.mode == "oversubscribe")
+    runOversubscription(opts, library, device);
+  else if (opts.mode == "priority")
+    runPriorityExperiment(opts, library, device);
+  else if (opts.mode == "paced")
+    runPacedRendering(opts, library, device);
+  else if (opts.mode == "adaptive")
+    runAdaptiveQuality(opts, library, device);
+  else if (opts.mode == "tiles")
+    runTiledRendering(opts, library, device);
+  else if (opts.mode == "shm")
+    runSharedMemoryProducer(opts, library, device);
+  else if (opts.mode == "worldswap")
+    runWorldSwap(opts, library, device);
+  else if (opts.mode == "playback")
+    runPlayback(opts, library, device);
+  else if (opts.mode == "lod")
+    runLevelOfDetail(opts, library, device);
+  else if (opts.mode == "surfaces")
+    runObjectCountScaling(opts, library, device);
+  else if (opts.mode == "arraypaths")
+    runObjectArrayPaths(opts, library, device);
+  else if (opts.mode == "quantized")
+    runQuantizedStorage(opts, library, device);
+  else if (opts.mode == "tonemap")
+    runToneMapping(opts, library, device);
+  else if (opts.mode == "roi")
+    runRegionOfInterest(opts, library, device);
+  else if (opts.mode == "views")
+    runMultiView(opts, library, device);
+  else if (opts.mode == "cameras")
+    runCameraTypes(opts, library, device);
+  else if (opts.mode == "introspection")
+    runIntrospection(opts, library, device);
+  else {
+    fprintf(stderr, "unknown mode: %s\n", opts.mode.c_str());
+    printUsage(argv[0]);
+    result = 1;
+  }
+
+  anari::release(device, device);
+  detachStatusRegistry(device);
+
+  anari::unloadLibrary(library);
+
+  return result;
 }
@@ -0,0 +1,166 @@
+// Copyright 2025 Stefan Zellmann
+// SPDX-License-Identifier: Apache-2.0
+
+// Stand-in for a separate display process: attaches to the framebuffer ring
+// published by `anari-multi-threading-test --mode shm`, copies out the newest
+// frame whenever one arrives and reports end-to-end latency and throughput.
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+// posix
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+// ours
+#include "shm_framebuffer.h"
+
+static double percentile(std::vector<double> v, double p)
+{
+  if (v.empty())
+    return 0.0;
+  std::sort(v.begin(), v.end());
+  size_t idx = size_t(std::ceil(p * v.size())) - 1;
+  return v[std::min(idx, v.size() - 1)];
+}
+
+static double mean(const std::vector<double> &v)
+{
+  return v.empty() ? 0.0 : std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+}
+
+int main(int argc, char *argv[])
+{
+  const std::string name = argc > 1 ? argv[1] : "/anari-framebuffer";
+
+  // Wait for the producer to create the ring //
+
+  int fd = -1;
+  for (int attempt = 0; attempt < 300 && fd < 0; attempt++) {
+    fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  if (fd < 0) {
+    fprintf(stderr, "could not open shared memory %s\n", name.c_str());
+    return 1;
+  }
+
+  // Only trust the header once it is complete and describes a ring that
+  // fits the segment, then map exactly that ring
+
+  struct stat st;
+  shmfb::Header *header = nullptr;
+  size_t mappedBytes = 0;
+  for (int attempt = 0; attempt < 300; attempt++) {
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(shmfb::Header)) {
+      void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (mem != MAP_FAILED) {
+        const auto *h = (const shmfb::Header *)mem;
+        const bool valid = h->magic == shmfb::kMagic;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint32_t numSlots = h->numSlots;
+        const size_t bytes = shmfb::totalBytes(numSlots, h->slotBytes);
+        munmap(mem, st.st_size);
+        if (valid && numSlots >= 1 && numSlots <= shmfb::kMaxSlots
+            && size_t(st.st_size) >= bytes) {
+          mem = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+          if (mem != MAP_FAILED) {
+            header = (shmfb::Header *)mem;
+            mappedBytes = bytes;
+            break;
+          }
+        }
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  close(fd);
+  if (!header) {
+    fprintf(stderr, "shared memory %s is not a framebuffer ring\n", name.c_str());
+    return 1;
+  }
+
+  printf("attached to %s: %u slots of %.1f MB\n",
+      name.c_str(), header->numSlots, header->slotBytes / 1e6);
+
+  // Consume the newest frame, like a display would //
+
+  std::vector<unsigned char> pixels(header->slotBytes);
+  std::vector<double> latencyMS, transportMS;
+  uint32_t lastSeen = header->published.load();
+  uint64_t received = 0, skipped = 0, torn = 0, bytes = 0;
+  uint64_t firstNS = 0, lastNS = 0;
+
+  for (;;) {
+    // Read 'closed' before 'published': the producer sets it after its last
+    // publish, so once it is seen, 'published' is final and gets drained
+    const bool closed = header->closed.load(std::memory_order_acquire);
+    const uint32_t published = header->published.load(std::memory_order_acquire);
+    if (published == lastSeen) {
+      if (closed)
+        break;
+      // A producer that died (e.g. was killed) never sets 'closed'
+      if (kill(header->producerPid, 0) != 0 && errno == ESRCH) {
+        fprintf(stderr, "producer %d is gone\n", header->producerPid);
+        break;
+      }
+      shmfb::futexWait(header->published, published, 100);
+      continue;
+    }
+
+    skipped += published - lastSeen - 1;
+    lastSeen = published;
+
+    auto &slot = header->slots[(published - 1) % header->numSlots];
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    const size_t frameBytes = size_t(slot.width) * slot.height * 4;
+    const uint64_t renderDoneNS = slot.renderDoneNS;
+    const uint64_t publishNS = slot.publishNS;
+    std::memcpy(pixels.data(),
+        shmfb::slotPixels(header, (published - 1) % header->numSlots),
+        std::min<size_t>(frameBytes, pixels.size()));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (before != published || slot.sequence.load() != before) {
+      torn++; // the producer lapped us while copying
+      continue;
+    }
+
+    const uint64_t now = shmfb::nowNS();
+    latencyMS.push_back((now - renderDoneNS) / 1e6);
+    transportMS.push_back((now - publishNS) / 1e6);
+    if (received++ == 0)
+      firstNS = now;
+    lastNS = now;
+    bytes += frameBytes;
+  }
+
+  const double seconds = (lastNS - firstNS) / 1e9;
+  printf("received %llu frames, skipped %llu, torn %llu\n",
+      (unsigned long long)received,
+      (unsigned long long)skipped,
+      (unsigned long long)torn);
+  if (received > 1 && seconds > 0.0) {
+    printf("throughput: %.2f fps, %.2f GB/s\n",
+        (received - 1) / seconds, bytes / seconds / 1e9);
+  }
+  printf("%-30s %10s %10s %10s\n", "[ms]", "mean", "p95", "max");
+  printf("%-30s %10.3f %10.3f %10.3f\n", "render done -> consumed",
+      mean(latencyMS), percentile(latencyMS, 0.95), percentile(latencyMS, 1.0));
+  printf("%-30s %10.3f %10.3f %10.3f\n", "published -> consumed",
+      mean(transportMS), percentile(transportMS, 0.95), percentile(transportMS, 1.0));
+
+  munmap(header, mappedBytes);
+  return 0;
+}
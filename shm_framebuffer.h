@@ -0,0 +1,89 @@
+// Copyright 2025 Stefan Zellmann
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// Layout of the shared-memory framebuffer ring written by
+// `anari-multi-threading-test --mode shm` and read by `anari-shm-consumer`.
+// Both processes must be built from the same version of this header.
+
+// std
+#include <atomic>
+#include <cstdint>
+// posix
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace shmfb {
+
+constexpr uint32_t kMagic = 0x31424641; // "AFB1"
+constexpr uint32_t kMaxSlots = 16;
+
+struct Slot
+{
+  // 0 while the producer writes the slot, otherwise the (1-based) sequence
+  // number of the frame it holds; readers check it before and after copying
+  std::atomic<uint64_t> sequence;
+  uint64_t renderDoneNS; // frame finished rendering (CLOCK_MONOTONIC)
+  uint64_t publishNS; // pixels were fully copied into the slot
+  uint32_t width;
+  uint32_t height;
+};
+
+struct Header
+{
+  uint32_t magic;
+  uint32_t numSlots;
+  uint64_t slotBytes;
+  std::atomic<uint32_t> published; // futex word: frames published so far
+  std::atomic<uint32_t> closed;
+  int32_t producerPid; // lets consumers notice a producer that died
+  Slot slots[kMaxSlots];
+};
+
+inline size_t totalBytes(uint32_t numSlots, uint64_t slotBytes)
+{
+  return sizeof(Header) + numSlots * slotBytes;
+}
+
+inline unsigned char *slotPixels(Header *header, uint32_t slot)
+{
+  return reinterpret_cast<unsigned char *>(header + 1)
+      + slot * header->slotBytes;
+}
+
+inline uint64_t nowNS()
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// Shared (not FUTEX_PRIVATE) futex ops, so they work across processes
+
+inline void futexWait(std::atomic<uint32_t> &word, uint32_t expected, long timeoutMS)
+{
+  timespec timeout{timeoutMS / 1000, (timeoutMS % 1000) * 1000000};
+  syscall(SYS_futex,
+      reinterpret_cast<uint32_t *>(&word),
+      FUTEX_WAIT,
+      expected,
+      &timeout,
+      nullptr,
+      0);
+}
+
+inline void futexWakeAll(std::atomic<uint32_t> &word)
+{
+  syscall(SYS_futex,
+      reinterpret_cast<uint32_t *>(&word),
+      FUTEX_WAKE,
+      INT32_MAX,
+      nullptr,
+      nullptr,
+      0);
+}
+
+} // namespace shmfb